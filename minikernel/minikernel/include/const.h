@@ -22,7 +22,7 @@
 #define NULL (void *) 0		/* por si acaso no esta ya definida */
 #endif
 
-#define MAX_PROC 10		/* dimension de tabla de procesos */
+#define MAX_PROC 4096		/* dimension maxima de tabla de procesos */
 
 #define TAM_PILA 32768
 
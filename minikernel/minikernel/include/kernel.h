@@ -18,12 +18,23 @@
 #ifndef _KERNEL_H
 #define _KERNEL_H
 
+//A22: dl_iterate_phdr y struct dl_phdr_info (link.h) son extensiones GNU
+#define _GNU_SOURCE
+
 #include "const.h"
 #include "HAL.h"
 #include "llamsis.h"
 //Añadido para A2: comparaciones de nombres de mutex
 #include <string.h>
 #include <stdlib.h>
+//A12: medida del tiempo transcurrido en un periodo de reloj largo
+#include <time.h>
+//A22: zonas de datos de las imágenes de programa
+#include <link.h>
+//A23: pilas con página de guarda y pila alternativa para las señales
+#include <sys/mman.h>
+#include <signal.h>
+#include <dlfcn.h>
 
 /*
  *
@@ -33,20 +44,89 @@
  */
 typedef struct BCP_t *BCPptr;
 
+/*
+ * A21: los campos que miran los recorridos de la tabla de procesos van al
+ * principio, para que quepan en la primera línea de caché del BCP, y cada
+ * BCP empieza en una línea propia. El contexto guardado (casi un kilobyte)
+ * no está dentro del BCP sino en un bloque aparte (ver bloques_contextos),
+ * así que recorrer la tabla no lo trae a la caché.
+ */
+#define TAM_LINEA_CACHE 64
+
+#define MAX_PILAS_FIBRAS 16	/* A28: pilas que puede pedir un proceso */
+
 typedef struct BCP_t {
         int id;						/* ident. del proceso */
         int estado;					/* TERMINADO|LISTO|EJECUCION|BLOQUEADO*/
-        contexto_t contexto_regs;	/* copia de regs. de UCP */
-        void * pila;				/* dir. inicial de la pila */
 		BCPptr siguiente;			/* puntero a otro BCP */
-		void *info_mem;				/* descriptor del mapa de memoria */
 		//Añadido por la práctica:
-		unsigned int segs_dormir;	/* segundos que debe dormir el proceso*/
 		//A2: se añade que cada proceso tenga acceso al descriptor de mutex.
 		int descriptores_mutex[NUM_MUT_PROC];
 		//A3: ticks de Round-Robin
 		int ticks;
-} BCP;
+		//A4: nivel de prioridad (0 es el más prioritario)
+		int prioridad;
+		//A5: cola de listos en la que está. Coincide con la prioridad salvo
+		//en modo MLFQ, donde varía entre prioridad y NUM_PRIORIDADES-1.
+		int nivel;
+		//A7: clase de tiempo real (EDF)
+		int clase;					/* CLASE_NORMAL|CLASE_TR */
+		//A9: grupo de reparto de CPU (índice en tabla_grupos)
+		int grupo;
+		//A10: CPU virtual a cuya cola de listos pertenece
+		int cpu;
+		/* fin de los campos calientes */
+        contexto_t *contexto_regs;	/* copia de regs. de UCP (A21: aparte) */
+        void * pila;				/* dir. inicial de la pila */
+		void *info_mem;				/* descriptor del mapa de memoria */
+		//A13: tick absoluto en que despierta y enlaces en la rueda de dormidos
+		unsigned long despertar;
+		BCPptr rueda_sig, rueda_ant;
+		BCPptr *rueda_ranura;		/* cabeza de la ranura en la que está */
+		//A6: tiempo virtual y nodo del árbol rojinegro de listos (CFS)
+		unsigned long long vruntime;
+		BCPptr arb_izq, arb_der, arb_padre;
+		int arb_color;
+		//A7: parámetros de tiempo real. Tiempos en ticks.
+		unsigned int tr_periodo, tr_presupuesto, tr_plazo;
+		int tr_util;				/* utilización reservada (por mil) */
+		int tr_restante;			/* presupuesto que queda en el periodo */
+		unsigned long tr_plazo_abs;	/* plazo de la activación en curso */
+		unsigned long tr_sig_activacion;
+		int tr_pendiente;			/* activación sin completar */
+		int tr_fallos;				/* plazos incumplidos */
+		BCPptr sig_tr;				/* lista de procesos de tiempo real */
+		//A8: contabilidad para comparar políticas
+		unsigned long ticks_creacion;	/* ticks_sistema al crearlo */
+		unsigned long ticks_cpu;		/* ticks ejecutando */
+		//A15: temporizador periódico (microsegundos del reloj monótono)
+		unsigned long long temp_periodo;	/* 0 si no tiene */
+		unsigned long long temp_siguiente;	/* próximo vencimiento */
+		//A16: retraso admitido al despertar, en microsegundos
+		unsigned int holgura;
+		//A22: imagen del programa y copia propia de sus datos
+		struct imagen_prog_t *imagen;
+		char *datos;
+		//A23: tamaño de su pila (índice en las reservas de pilas)
+		int clase_pila;
+		//A25: padre e hijos, estado de terminación y espera por un hijo
+		BCPptr padre;				/* NULL si no tiene o ya ha terminado */
+		BCPptr primer_hijo, sig_hermano, ant_hermano;
+		int estado_salida;
+		int hijo_esperado;			/* pid|ESPERA_CUALQUIERA|NO_ESPERA */
+		//A27: lista en la que está bloqueado (NULL si no está en ninguna o
+		//sólo en la rueda de dormidos), para poder sacarlo al matarlo
+		struct lista_BCPs_t *lista_bloqueo;
+		//A27: proceso al que pertenece (él mismo si no es un hilo), hilos
+		//del proceso y función y argumento con los que arranca un hilo
+		BCPptr proceso;
+		BCPptr primer_hilo, sig_hilo, ant_hilo;
+		void *hilo_funcion, *hilo_arg;
+		void *pila_hilo;			/* la de un hilo terminado, sin limpiar */
+		//A28: pilas pedidas para las fibras, que se devuelven al terminar
+		void *pilas_fibras[MAX_PILAS_FIBRAS];
+		int num_pilas_fibras;
+} __attribute__((aligned(TAM_LINEA_CACHE))) BCP;
 
 /*
  *
@@ -56,7 +136,7 @@ typedef struct BCP_t {
  *
  */
 
-typedef struct{
+typedef struct lista_BCPs_t {
 	BCP *primero;
 	BCP *ultimo;
 } lista_BCPs;
@@ -70,19 +150,369 @@ BCP * p_proc_actual=NULL;
 
 /*
  * Variable global que representa la tabla de procesos
+ *
+ * A20: la tabla crece por bloques de BCP_POR_BLOQUE hasta MAX_PROC. Los
+ * bloques no se mueven, porque hay punteros a los BCP por todas partes y
+ * el contexto guardado en ellos no se puede copiar. Las entradas libres
+ * forman una cola (enlazada por siguiente) en la que se reutiliza primero
+ * la que lleva más tiempo libre. El identificador de un proceso lleva en
+ * los bits bajos el índice de su entrada y en los altos una generación
+ * que aumenta cada vez que se libera, así que un identificador viejo no
+ * se confunde con el proceso que ocupa ahora su entrada.
  */
+#define BCP_POR_BLOQUE 16	/* la tabla crece de bloque en bloque */
+#define BITS_INDICE_PID 12	/* 1<<BITS_INDICE_PID >= MAX_PROC */
+#define INDICE_PID(pid) ((pid) & ((1<<BITS_INDICE_PID)-1))
+#define BCP_TABLA(i) (&bloques_procs[(i)/BCP_POR_BLOQUE][(i)%BCP_POR_BLOQUE])
+
+BCP *bloques_procs[MAX_PROC/BCP_POR_BLOQUE];
+contexto_t *bloques_contextos[MAX_PROC/BCP_POR_BLOQUE];	/* A21 */
+int tam_tabla_procs=0;		/* entradas creadas hasta ahora */
+lista_BCPs lista_libres={NULL, NULL};
 
-BCP tabla_procs[MAX_PROC];
+/*
+ * Niveles de prioridad de los procesos listos (A4). El nivel 0 es el
+ * más prioritario.
+ */
+#define NUM_PRIORIDADES 8
+#define PRIORIDAD_DEF 4
 
 /*
- * Variable global que representa la cola de procesos listos
+ * Política MLFQ (A5): cada PERIODO_BOOST ticks todos los procesos vuelven
+ * al nivel de su prioridad.
  */
-lista_BCPs lista_listos= {NULL, NULL};
+#define PERIODO_BOOST 100
+
+int ticks_hasta_boost=PERIODO_BOOST;
 
 /*
- * Variable global que representa la cola de procesos dormidos
+ * Reparto equitativo (A6, política CFS). Cada proceso acumula tiempo
+ * virtual en proporción inversa a su peso, que depende de su prioridad,
+ * y se ejecuta el que menos lleva. Los listos se guardan en un árbol
+ * rojinegro ordenado por vruntime del que se cachea el nodo mínimo.
+ * Los tiempos virtuales se miden en microsegundos.
  */
-lista_BCPs lista_dormidos= {NULL, NULL};
+#define VRUNTIME_TICK (1000000/TICK)	/* tiempo virtual de un tick a peso normal */
+#define PESO_NORMAL 1024		/* peso de PRIORIDAD_DEF */
+#define CFS_GRANULARIDAD (2*VRUNTIME_TICK) /* ventaja mínima para expulsar */
+#define CFS_LATENCIA (20*VRUNTIME_TICK)	/* crédito máximo al despertar */
+
+#define ROJO 0
+#define NEGRO 1
+
+const int pesos_prioridad[NUM_PRIORIDADES]=
+	{6100, 3906, 2501, 1586, 1024, 655, 423, 272};
+
+typedef struct
+{
+		BCP *raiz;
+		BCP *primero;	/* nodo con menor vruntime */
+} arbol_t;
+
+/*
+ * Clase de tiempo real (A7). Los procesos admitidos declaran periodo,
+ * presupuesto y plazo, y se planifican por plazo más próximo (EDF) antes
+ * que los procesos normales. Un proceso que agota su presupuesto no
+ * vuelve a ejecutar hasta su siguiente periodo. Sólo se admite un proceso
+ * si la utilización total (presupuesto/plazo) no supera UTIL_MAX_TR, lo
+ * que deja parte del procesador a los procesos normales.
+ */
+#define CLASE_NORMAL 0
+#define CLASE_TR 1
+
+#define UTIL_MAX_TR 900		/* utilización máxima, por mil */
+
+/*
+ * Variable global que cuenta los ticks de reloj desde el arranque
+ */
+unsigned long ticks_sistema=0;
+
+/*
+ * Variable global que representa la cola de procesos de tiempo real
+ * listos, ordenada por plazo
+ */
+lista_BCPs cola_tr= {NULL, NULL};
+
+BCP *procs_tr=NULL;		/* todos los procesos de tiempo real */
+int utilizacion_tr=0;		/* utilización reservada, por mil */
+
+/*
+ * CPUs virtuales (A10). Cada una tiene su proceso actual, sus estructuras
+ * de listos (las colas por nivel con su mapa de bits y el árbol del CFS)
+ * y su contabilidad de ticks. El núcleo las ejecuta por turnos de un tick
+ * sobre el único procesador que da el HAL, de modo que siguen protegidas
+ * por los niveles de interrupción como el resto del núcleo. Un proceso
+ * se queda en la CPU en la que se crea salvo que otra sin trabajo se lo
+ * robe. Los de tiempo real se ejecutan siempre en la CPU 0.
+ */
+#define MAX_CPUS 4
+
+typedef struct
+{
+		BCP *actual;		/* proceso en ejecución, NULL si está ociosa */
+		lista_BCPs colas_listos[NUM_PRIORIDADES]; /* una cola FIFO por nivel */
+		unsigned int mapa_listos;	/* niveles no vacíos */
+		arbol_t arbol;		/* listos del CFS */
+		unsigned long long min_vruntime; /* cota inferior monótona de vruntime */
+		int nlistos;		/* procesos normales listos */
+		BCP *cedido;		/* A11: ejecutará a continuación, si sigue listo */
+		unsigned long ticks_ocupada;
+		unsigned long ticks_ociosa;
+} cpu_t;
+
+cpu_t tabla_cpus[MAX_CPUS];
+
+int num_cpus=1;
+int cpu_actual=0;	/* CPU a la que pertenece p_proc_actual */
+int rotar_cpus=0;	/* int_sw debe pasar a la siguiente CPU */
+
+/*
+ * Reloj dinámico (A12). Si se arranca con RELOJ=dinamico, mientras no
+ * hay más de un proceso listo el reloj se programa para interrumpir cada
+ * varios ticks, hasta el siguiente evento temporal previsto, y cada
+ * interrupción procesa todos los ticks transcurridos. Como el HAL sólo
+ * admite frecuencias enteras, los ticks por interrupción son un divisor
+ * de TICK, como mucho un segundo.
+ */
+int reloj_dinamico=0;
+int ticks_por_int=1;		/* ticks que cuenta cada interrupción */
+struct timespec ultimo_tick;	/* inicio del periodo actual */
+
+/*
+ * Medida del tiempo (A14). El reloj monótono cuenta microsegundos desde
+ * el arranque a partir de los ticks del sistema, interpolando dentro del
+ * tick actual; el reloj CMOS da el tiempo transcurrido según el reloj
+ * del hardware y sirve de referencia para medir la deriva del primero.
+ */
+#define US_POR_TICK (1000000/TICK)
+
+#define RELOJ_MONOTONO 0
+#define RELOJ_CMOS 1
+
+unsigned long long cmos_arranque;	/* leer_reloj_CMOS() al arrancar */
+
+/*
+ * Holgura de los temporizadores (A16). Un proceso puede admitir que su
+ * despertar se retrase hasta su holgura para que coincida en el mismo
+ * tick con el de otros procesos, de modo que se despiertan en lote. Su
+ * efecto se ve en los contadores siguientes.
+ */
+unsigned long cambios_contexto=0;	/* llamadas a cambio_contexto */
+unsigned long ticks_despertar=0;	/* ticks en que despierta alguien */
+
+/*
+ * Tiempo virtual (A17). Si se arranca con TIEMPO=virtual, cuando no hay
+ * ningún proceso listo y hay algún evento temporal previsto, en vez de
+ * esperar a las interrupciones de reloj se procesan de golpe los ticks
+ * que faltan hasta él. Los procesos ven los mismos ticks que en tiempo
+ * real, pero las esperas no consumen tiempo real. El reloj CMOS que ven
+ * los procesos suma lo saltado para que no se desvíe del monótono.
+ */
+#define MAX_SALTO (1<<30)	/* ticks; más allá no hay evento */
+
+int tiempo_virtual=0;
+unsigned long long us_saltados=0;	/* tiempo real ahorrado */
+
+/*
+ * Trabajo diferido (A18). Cada trabajo tiene un bit en diferidos y una
+ * función en tabla_diferidos que lo hace a nivel 1.
+ */
+#define DIFERIDO_RELOJ 0
+#define DIFERIDO_TERMINADOS 1	/* A25 */
+#define NUM_DIFERIDOS 2
+
+unsigned int diferidos=0;	/* bit i: trabajo i pendiente */
+int ticks_pendientes=0;		/* ticks anotados y aún sin procesar */
+int expulsion_pendiente=0;	/* la int. SW debe replanificar */
+
+typedef struct{
+	void (*funcion)();
+} diferido;
+
+void trabajo_reloj();
+void trabajo_terminados();
+
+diferido tabla_diferidos[NUM_DIFERIDOS]={ {trabajo_reloj}, {trabajo_terminados} };
+
+/*
+ * Tareas de fondo (A19). Trabajo que se adelanta mientras no hay ningún
+ * proceso listo, en trozos cortos para no retrasar al que se despierte.
+ * La función de cada tarea hace un trozo y devuelve 0 si no tenía nada
+ * que hacer.
+ */
+#define NUM_TAREAS_FONDO 1
+#define TROZO_FONDO 4096	/* bytes de pila que se limpian por trozo */
+
+typedef struct{
+	char *nombre;
+	int (*trozo)();
+} tarea_fondo;
+
+int tarea_limpiar_pilas();
+
+tarea_fondo tabla_tareas_fondo[NUM_TAREAS_FONDO]={ {"pilas", tarea_limpiar_pilas} };
+int turno_fondo=0;
+
+/*
+ * Reserva de pilas (A19). Las de los procesos que terminan se limpian en
+ * segundo plano y se reutilizan en vez de pedir otra en crear_tarea.
+ *
+ * A23: hay NUM_CLASES_PILA tamaños de pila, potencias de dos a partir de
+ * TAM_PILA_MIN, cada uno con su reserva de limpias. La del tamaño por
+ * defecto se llena en el arranque y las demás en cuanto algún programa
+ * usa ese tamaño. Un programa pide otro tamaño definiendo tam_pila (ver
+ * TAMANO_PILA en servicios.h). Las pilas se piden con mmap y tienen
+ * debajo TAM_GUARDA_PILA bytes sin permisos: desbordarlas produce una
+ * excepción de memoria, que se trata en pila_senales porque en la del
+ * proceso ya no cabe.
+ */
+#define RESERVA_PILAS 2		/* limpias que se preparan de antemano */
+#define MAX_PILAS_FONDO 32
+#define TAM_PILA_MIN 16384
+#define NUM_CLASES_PILA 5	/* de 16 KB a 256 KB */
+#define TAM_CLASE_PILA(c) (TAM_PILA_MIN<<(c))
+#define TAM_GUARDA_PILA 4096
+#define TAM_PILA_SENALES 65536
+
+typedef struct{
+	void *pila;
+	int clase;
+	int limpio;		/* bytes ya puestos a cero */
+} pila_sucia;
+
+pila_sucia pilas_sucias[MAX_PILAS_FONDO];
+int num_pilas_sucias=0;
+void *pilas_limpias[NUM_CLASES_PILA][MAX_PILAS_FONDO];
+int num_pilas_limpias[NUM_CLASES_PILA];
+int reserva_pilas[NUM_CLASES_PILA];	/* limpias que se quieren tener */
+int num_pilas_guardadas=0;	/* sucias y limpias */
+pila_sucia pila_pendiente;	/* A23: la última que no cabía, por liberar */
+/* A25: pilas del proceso que se está recogiendo a sí mismo al terminar,
+   que se devuelven cuando ya no se ejecuta sobre ellas */
+#define MAX_PILAS_SALIDA (1+MAX_PILAS_FIBRAS)	/* A28: puede terminar en una fibra */
+void *pilas_salida[MAX_PILAS_SALIDA];
+int num_pilas_salida=0;
+int clase_pilas_salida;
+char pila_senales[TAM_PILA_SENALES];
+
+/*
+ * Terminación de procesos (A25). Un proceso que termina sólo deja lo
+ * imprescindible y pasa a lista_terminados; el trabajo diferido
+ * DIFERIDO_TERMINADOS devuelve después su pila y su imagen. Si su padre
+ * sigue vivo se queda como ZOMBI, con su estado de terminación, hasta que
+ * el padre lo recoge con esperar_proceso; si no, se libera su entrada.
+ */
+#define ZOMBI 4		/* terminado, hasta que lo espere su padre */
+#define ESPERA_CUALQUIERA -1
+#define NO_ESPERA -2
+#define ESTADO_EXCEPCION -1		/* estado de los que mueren por excepción */
+
+lista_BCPs lista_terminados={NULL, NULL};
+lista_BCPs lista_esperando_hijos={NULL, NULL};
+
+/*
+ * Hilos (A27). Un hilo es un BCP más para el planificador, con su pila y
+ * su contexto, pero comparte con su proceso la imagen, los datos, los
+ * descriptores de mutex y los hijos. Al terminar queda como ZOMBI hasta
+ * que otro hilo del proceso lo espera con esperar_hilo, y cuando termina
+ * el proceso se matan los hilos que le queden, estén donde estén. Los que
+ * esperan por un hilo también van en lista_esperando_hijos.
+ */
+#define ESTADO_MATADO -2		/* estado de los hilos que mueren con su proceso */
+
+/*
+ * A26: procesos esperando a que quede libre una entrada de la tabla de
+ * procesos para crear uno (crear_proceso_espera). Cada entrada que se
+ * libera despierta al primero; si esperan con plazo, están también en la
+ * rueda de dormidos y el que despierta por plazo sale de esta lista (A27:
+ * la anotada en su lista_bloqueo).
+ */
+#define ESPERA_INDEFINIDA -1
+
+lista_BCPs lista_esperando_entrada={NULL, NULL};
+
+/*
+ * Caché de imágenes (A22). Cada programa se carga una sola vez con
+ * crear_imagen y todos sus procesos usan esa imagen. Cuando se queda sin
+ * procesos se guarda por si se vuelve a crear, hasta MAX_IMAGENES_SIN_USO,
+ * y se descarta la que lleve más tiempo sin usarse. El código es común,
+ * pero cada proceso tiene su copia de la zona escribible de la imagen
+ * (datos y bss): en la imagen está puesta la de su dueño y se cambia por
+ * la del proceso que pasa a ejecutar si es otro.
+ */
+#define MAX_IMAGENES_SIN_USO 8
+
+typedef struct imagen_prog_t {
+	char *nombre;
+	void *mem;			/* lo que devuelve crear_imagen */
+	void *pc_inicial;
+	int nrefs;			/* procesos que la usan */
+	char *datos;		/* zona escribible de la imagen */
+	size_t tam_datos;
+	char *datos_ini;	/* copia de esa zona recién cargada */
+	BCP *dueno;			/* proceso cuyos datos están puestos */
+	int clase_pila;		/* A23: tamaño de pila que pide */
+	struct imagen_prog_t *siguiente;
+} imagen_prog;
+
+imagen_prog *lista_imagenes=NULL;	/* la usada más recientemente primero */
+int num_imagenes_sin_uso=0;
+int procesos_vivos=0;
+
+/*
+ * Grupos de reparto de CPU (A9). Forman un árbol cuya raíz es el grupo
+ * 0, y cada proceso pertenece al grupo de su creador. Un grupo recibe un
+ * porcentaje (reparto) de la CPU de su padre, que sólo se aplica cuando
+ * otros procesos del padre quieren ejecutar, y opcionalmente una cuota
+ * de ticks que no puede superar en ninguna ventana. El consumo se cuenta
+ * por ventanas de VENTANA_GRUPOS ticks; un grupo que agota lo suyo queda
+ * limitado y sus procesos salen de los listos hasta la siguiente ventana.
+ */
+#define MAX_GRUPOS 16
+#define VENTANA_GRUPOS 50
+
+#define GRUPO_LIBRE 0
+#define GRUPO_USADO 1
+
+typedef struct Grupo_t
+{
+		int estado;
+		int padre;		/* índice del grupo padre, -1 en la raíz */
+		int reparto;	/* porcentaje de la CPU del padre */
+		int limite;		/* ticks por ventana que da el reparto */
+		int cuota;		/* ticks máximos por ventana, 0 si no hay */
+		int usados;		/* ticks consumidos en la ventana actual */
+		int nlistos;	/* procesos listos del grupo y sus subgrupos */
+		int nrefs;		/* procesos y subgrupos que lo usan */
+		int limitado;	/* ha agotado lo suyo en esta ventana */
+} Grupo;
+
+Grupo tabla_grupos[MAX_GRUPOS];
+
+int ticks_hasta_recarga=VENTANA_GRUPOS;
+
+/*
+ * Variable global que representa la lista de procesos apartados de los
+ * listos por pertenecer a un grupo limitado
+ */
+lista_BCPs lista_limitados= {NULL, NULL};
+
+/*
+ * Variable global que representa los procesos dormidos (A13): una rueda
+ * de temporización jerárquica indexada por el tick absoluto en que
+ * despiertan. El nivel 0 tiene una ranura por tick para los próximos
+ * RANURAS_RUEDA ticks y cada ranura del nivel l abarca RANURAS_RUEDA^l
+ * ticks; cuando el nivel 0 da una vuelta, la ranura que toca del nivel
+ * siguiente se reparte entre los inferiores. Insertar y quitar son O(1)
+ * y un tick sólo mira la ranura que vence.
+ */
+#define BITS_RUEDA 6
+#define RANURAS_RUEDA (1<<BITS_RUEDA)
+#define NIVELES_RUEDA 5	/* alcance de 2^30 ticks; más allá se recorta */
+
+BCP *rueda_dormidos[NIVELES_RUEDA][RANURAS_RUEDA];
+int num_rueda[NIVELES_RUEDA];	/* procesos en cada nivel */
+unsigned long base_rueda=1;	/* siguiente tick que procesará la rueda */
 
 #define NO_RECURSIVO 0
 #define RECURSIVO 1
@@ -115,6 +545,78 @@ Mutex tabla_mutex[NUM_MUT];
  */
 lista_BCPs lista_bloqueados = {NULL, NULL};
 
+/*
+ *
+ * Definicion del tipo que corresponde con una política de planificación
+ * (A8). Las operaciones que pueden ser NULL son opcionales.
+ *
+ */
+typedef struct{
+	char *nombre;
+	void (*iniciar)(BCP *proc);	/* al crearlo o cambiar su prioridad */
+	void (*encolar)(BCP *proc);	/* pasa a estar listo */
+	void (*desencolar)(BCP *proc);	/* deja de estar listo */
+	BCP *(*elegir)();		/* siguiente a ejecutar, o NULL */
+	int (*tick)(BCP *proc);		/* tick del actual (NULL si no es suyo);
+					   devuelve 1 si hay que replanificar */
+	void (*bloquear)(BCP *proc);	/* opcional: el actual se bloquea */
+	void (*despertar)(BCP *proc);	/* opcional: se desbloquea */
+	int (*expulsa)(BCP *proc);	/* un nuevo listo expulsa al actual */
+	void (*ceder)(BCP *proc);	/* el actual cede el procesador */
+} planificar_t;
+
+/*
+ * Prototipos de las operaciones de cada política
+ */
+void colas_encolar(BCP *proc);
+void colas_desencolar(BCP *proc);
+BCP *colas_elegir();
+int colas_expulsa(BCP *proc);
+void colas_ceder(BCP *proc);
+void fifo_iniciar(BCP *proc);
+int fifo_tick(BCP *proc);
+int fifo_expulsa(BCP *proc);
+void rr_iniciar(BCP *proc);
+int rr_tick(BCP *proc);
+void rr_despertar(BCP *proc);
+void prio_iniciar(BCP *proc);
+void mlfq_iniciar(BCP *proc);
+int mlfq_tick(BCP *proc);
+void mlfq_bloquear(BCP *proc);
+void cfs_iniciar(BCP *proc);
+void cfs_encolar(BCP *proc);
+void cfs_desencolar(BCP *proc);
+BCP *cfs_elegir();
+int cfs_tick(BCP *proc);
+void cfs_despertar(BCP *proc);
+int cfs_expulsa(BCP *proc);
+void cfs_ceder(BCP *proc);
+
+/*
+ * Variable global que contiene las políticas disponibles. Se elige una
+ * en el arranque con la variable de entorno PLANIFICADOR; si no está
+ * definida se usa POLITICA_DEF.
+ */
+#define NUM_POLITICAS 5
+#define POLITICA_DEF "prio"
+
+planificar_t tabla_politicas[NUM_POLITICAS]={
+	{"fifo", fifo_iniciar, colas_encolar, colas_desencolar, colas_elegir,
+		fifo_tick, NULL, NULL, fifo_expulsa, colas_ceder},
+	{"rr", rr_iniciar, colas_encolar, colas_desencolar, colas_elegir,
+		rr_tick, NULL, rr_despertar, colas_expulsa, colas_ceder},
+	{"prio", prio_iniciar, colas_encolar, colas_desencolar, colas_elegir,
+		rr_tick, NULL, rr_despertar, colas_expulsa, colas_ceder},
+	{"mlfq", mlfq_iniciar, colas_encolar, colas_desencolar, colas_elegir,
+		mlfq_tick, mlfq_bloquear, NULL, colas_expulsa, colas_ceder},
+	{"cfs", cfs_iniciar, cfs_encolar, cfs_desencolar, cfs_elegir,
+		cfs_tick, NULL, cfs_despertar, cfs_expulsa, cfs_ceder} };
+
+/*
+ * Variable global que apunta a la política activa
+ */
+planificar_t *politica=NULL;
+
 /*
  *
  * Definicion del tipo que corresponde con una entrada en la tabla de
@@ -140,6 +642,31 @@ int sis_abrir_mutex();
 int sis_lock();
 int sis_unlock();
 int sis_cerrar_mutex();
+int sis_fijar_prioridad(); //A4: servicio para cambiar la prioridad del proceso.
+int sis_fijar_tiempo_real(); //A7: servicio para pasar a la clase de tiempo real.
+int sis_crear_grupo(); //A9: servicio para crear un grupo de reparto de CPU.
+//A11: servicios para ceder el procesador
+int sis_ceder();
+int sis_ceder_a();
+//A14: servicios de tiempo con resolución inferior al segundo
+int sis_dormir_ms();
+int sis_dormir_us();
+int sis_obtener_tiempo();
+//A15: esperas absolutas y temporizador periódico
+int sis_dormir_hasta();
+int sis_fijar_temporizador();
+int sis_esperar_temporizador();
+int sis_fijar_holgura(); //A16: retraso admitido al despertar.
+int sis_crear_procesos(); //A24: creación de varios procesos en una llamada.
+int sis_esperar_proceso(); //A25: espera a que termine un hijo.
+int sis_crear_proceso_espera(); //A26: crea un proceso esperando sitio en la tabla.
+//A27: hilos
+int sis_crear_hilo();
+int sis_esperar_hilo();
+int sis_arrancar_hilo();
+//A28: apoyo a las fibras de la biblioteca
+int sis_intentar_lock();
+int sis_pedir_pila();
 /*
  * Variable global que contiene las rutinas que realizan cada llamada
  */
@@ -152,7 +679,27 @@ servicio tabla_servicios[NSERVICIOS]={	{sis_crear_proceso},
 					{sis_abrir_mutex},
 					{sis_lock},
 					{sis_unlock},
-					{sis_cerrar_mutex} };
+					{sis_cerrar_mutex},
+					{sis_fijar_prioridad},
+					{sis_fijar_tiempo_real},
+					{sis_crear_grupo},
+					{sis_ceder},
+					{sis_ceder_a},
+					{sis_dormir_ms},
+					{sis_dormir_us},
+					{sis_obtener_tiempo},
+					{sis_dormir_hasta},
+					{sis_fijar_temporizador},
+					{sis_esperar_temporizador},
+					{sis_fijar_holgura},
+					{sis_crear_procesos},
+					{sis_esperar_proceso},
+					{sis_crear_proceso_espera},
+					{sis_crear_hilo},
+					{sis_esperar_hilo},
+					{sis_arrancar_hilo},
+					{sis_intentar_lock},
+					{sis_pedir_pila} };
 
 #endif /* _KERNEL_H */
 
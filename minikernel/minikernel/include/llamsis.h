@@ -19,7 +19,7 @@
 #define _LLAMSIS_H
 
 /* Numero de llamadas disponibles */
-#define NSERVICIOS 10
+#define NSERVICIOS 30
 
 #define CREAR_PROCESO 0
 #define TERMINAR_PROCESO 1
@@ -31,6 +31,28 @@
 #define LOCK_MUTEX 7
 #define UNLOCK_MUTEX 8
 #define CERRAR_MUTEX 9
+#define FIJAR_PRIORIDAD 10 //A4: cambia la prioridad del proceso que llama.
+#define FIJAR_TIEMPO_REAL 11 //A7: declara periodo, presupuesto y plazo.
+#define CREAR_GRUPO 12 //A9: crea un grupo de reparto de CPU y entra en él.
+#define CEDER 13 //A11: pasa detrás de los listos de su nivel.
+#define CEDER_A 14 //A11: cede lo que le queda de rodaja a otro proceso.
+#define DORMIR_MS 15 //A14: dormir en milisegundos.
+#define DORMIR_US 16 //A14: dormir en microsegundos.
+#define OBTENER_TIEMPO 17 //A14: lee el reloj monótono o el CMOS.
+#define DORMIR_HASTA 18 //A15: dormir hasta un instante absoluto.
+#define FIJAR_TEMPORIZADOR 19 //A15: arma el temporizador periódico.
+#define ESPERAR_TEMPORIZADOR 20 //A15: espera su siguiente vencimiento.
+#define FIJAR_HOLGURA 21 //A16: retraso admitido al despertar.
+#define CREAR_PROCESOS 22 //A24: crea varios procesos de un programa de una vez.
+#define ESPERAR_PROCESO 23 //A25: espera a que termine un hijo y recoge su estado.
+#define CREAR_PROCESO_ESPERA 24 //A26: crea un proceso esperando sitio en la tabla.
+//A27: hilos que comparten la imagen del proceso
+#define CREAR_HILO 25
+#define ESPERAR_HILO 26
+#define ARRANCAR_HILO 27 //la usa el hilo al arrancar para saber qué ejecutar
+//A28: apoyo a las fibras de la biblioteca
+#define INTENTAR_LOCK 28
+#define PEDIR_PILA 29
 
 #endif /* _LLAMSIS_H */
 
@@ -39,36 +39,188 @@ static int buscar_mutex_libre()
 /*
  *
  * Funciones relacionadas con la tabla de procesos:
- *	iniciar_tabla_proc buscar_BCP_libre
+ *	iniciar_tabla_proc crecer_tabla_proc buscar_BCP_libre liberar_BCP
+ *	buscar_proceso
  *
  */
 
+/*
+ * A20: añade un bloque de entradas libres a la tabla de procesos.
+ * Devuelve -1 si ya tiene el tamaño máximo o no hay memoria.
+ * A21: el bloque de BCP va alineado a línea de caché y los contextos en
+ * otro bloque paralelo.
+ */
+static int crecer_tabla_proc(){
+	BCP *bloque, *p;
+	contexto_t *contextos;
+	int i;
+
+	if (tam_tabla_procs>=MAX_PROC)
+		return -1;
+	if (posix_memalign((void **)&bloque, TAM_LINEA_CACHE,
+	    BCP_POR_BLOQUE*sizeof(BCP)))
+		return -1;
+	contextos=malloc(BCP_POR_BLOQUE*sizeof(contexto_t));
+	if (contextos==NULL) {
+		free(bloque);
+		return -1;
+	}
+	bloques_procs[tam_tabla_procs/BCP_POR_BLOQUE]=bloque;
+	bloques_contextos[tam_tabla_procs/BCP_POR_BLOQUE]=contextos;
+	for (i=0; i<BCP_POR_BLOQUE; i++) {
+		p=&bloque[i];
+		p->contexto_regs=&contextos[i];
+		p->padre=NULL; /* A25: ver buscar_hijo */
+		p->estado=NO_USADA;
+		p->id=tam_tabla_procs+i;	/* generación 0 */
+		p->siguiente=NULL;
+		if (lista_libres.ultimo)
+			lista_libres.ultimo->siguiente=p;
+		else
+			lista_libres.primero=p;
+		lista_libres.ultimo=p;
+	}
+	tam_tabla_procs+=BCP_POR_BLOQUE;
+	return 0;
+}
+
 /*
  * Funci�n que inicia la tabla de procesos
  */
 static void iniciar_tabla_proc(){
+	crecer_tabla_proc(); //A20: el primer bloque.
+}
+
+/*
+ * Funci�n que busca una entrada libre en la tabla de procesos. A20:
+ * saca la primera de la cola de libres, haciendo crecer la tabla si está
+ * vacía. Devuelve NULL si no queda sitio.
+ */
+static BCP * buscar_BCP_libre(){
+	BCP *p;
+
+	if (lista_libres.primero==NULL && crecer_tabla_proc()<0)
+		return NULL;
+	p=lista_libres.primero;
+	lista_libres.primero=p->siguiente;
+	if (lista_libres.primero==NULL)
+		lista_libres.ultimo=NULL;
+	return p;
+}
+
+static void avisar_entrada_libre();
+
+/*
+ * A20: devuelve una entrada al final de la cola de libres, pasando su
+ * identificador a la siguiente generación. A26: despierta al primero que
+ * esté esperando sitio en la tabla.
+ */
+static void liberar_BCP(BCP * p){
+	p->estado=NO_USADA;
+	p->id=(p->id+(1<<BITS_INDICE_PID)) & 0x7fffffff;
+	p->siguiente=NULL;
+	if (lista_libres.ultimo)
+		lista_libres.ultimo->siguiente=p;
+	else
+		lista_libres.primero=p;
+	lista_libres.ultimo=p;
+	if (lista_esperando_entrada.primero)
+		avisar_entrada_libre();
+}
+
+/*
+ * A20: devuelve el proceso con ese identificador, o NULL si no existe o
+ * su entrada ya es de otro proceso. A25: un zombi tampoco cuenta.
+ */
+static BCP * buscar_proceso(int pid){
+	BCP *p;
+
+	if (pid<0 || INDICE_PID(pid)>=tam_tabla_procs)
+		return NULL;
+	p=BCP_TABLA(INDICE_PID(pid));
+	if (p->estado==NO_USADA || p->estado==ZOMBI || p->id!=pid)
+		return NULL;
+	return p;
+}
+
+/*
+ *
+ * Funciones relacionadas con la tabla de grupos (A9):
+ *	iniciar_tabla_grupos buscar_grupo_libre contar_listo grupo_limitado
+ *	soltar_grupo
+ *
+ */
+
+/*
+ * Función que inicia la tabla de grupos con el grupo raíz, que no tiene
+ * reparto ni cuota
+ */
+static void iniciar_tabla_grupos(){
 	int i;
 
-	for (i=0; i<MAX_PROC; i++)
-		tabla_procs[i].estado=NO_USADA;
+	for (i=1; i<MAX_GRUPOS; i++)
+		tabla_grupos[i].estado=GRUPO_LIBRE;
+	tabla_grupos[0].estado=GRUPO_USADO;
+	tabla_grupos[0].padre=-1;
+	tabla_grupos[0].reparto=100;
+	tabla_grupos[0].limite=VENTANA_GRUPOS;
+	tabla_grupos[0].cuota=0;
+	tabla_grupos[0].usados=0;
+	tabla_grupos[0].nlistos=0;
+	tabla_grupos[0].nrefs=0;
+	tabla_grupos[0].limitado=0;
 }
 
 /*
- * Funci�n que busca una entrada libre en la tabla de procesos
+ * Función que busca una entrada libre en la tabla de grupos
  */
-static int buscar_BCP_libre(){
+static int buscar_grupo_libre(){
 	int i;
 
-	for (i=0; i<MAX_PROC; i++)
-		if (tabla_procs[i].estado==NO_USADA)
+	for (i=1; i<MAX_GRUPOS; i++)
+		if (tabla_grupos[i].estado==GRUPO_LIBRE)
 			return i;
 	return -1;
 }
 
+/*
+ * Suma inc a los listos del grupo del proceso y de todos sus ancestros
+ */
+static void contar_listo(BCP * proc, int inc){
+	int g;
+
+	for (g=proc->grupo; g!=-1; g=tabla_grupos[g].padre)
+		tabla_grupos[g].nlistos+=inc;
+}
+
+/*
+ * Indica si el proceso pertenece a un grupo limitado, directamente o a
+ * través de alguno de sus ancestros
+ */
+static int grupo_limitado(BCP * proc){
+	int g;
+
+	for (g=proc->grupo; g!=-1; g=tabla_grupos[g].padre)
+		if (tabla_grupos[g].limitado)
+			return 1;
+	return 0;
+}
+
+/*
+ * Quita una referencia al grupo. Si ya no lo usa nadie se libera, lo que
+ * a su vez quita una referencia a su padre. El grupo raíz no se libera.
+ */
+static void soltar_grupo(int g){
+	while (g>0 && --tabla_grupos[g].nrefs==0) {
+		tabla_grupos[g].estado=GRUPO_LIBRE;
+		g=tabla_grupos[g].padre;
+	}
+}
+
 /*
  *
  * Funciones que facilitan el manejo de las listas de BCPs
- *	insertar_ultimo eliminar_primero eliminar_elem
+ *	insertar_ultimo eliminar_primero eliminar_elem insertar_por_plazo
  *
  * NOTA: PRIMERO SE DEBE LLAMAR A eliminar Y LUEGO A insertar
  */
@@ -114,74 +266,1954 @@ static void eliminar_elem(lista_BCPs *lista, BCP * proc){
 	}
 }
 
+/*
+ * Inserta un BCP en una lista ordenada por plazo absoluto. A igualdad
+ * de plazo, detrás de los que ya estaban.
+ */
+static void insertar_por_plazo(lista_BCPs *lista, BCP * proc){
+	BCP *paux=lista->primero;
+
+	if (paux==NULL || proc->tr_plazo_abs < paux->tr_plazo_abs) {
+		proc->siguiente=paux;
+		lista->primero=proc;
+		if (paux==NULL)
+			lista->ultimo=proc;
+		return;
+	}
+	for ( ; paux->siguiente &&
+		paux->siguiente->tr_plazo_abs <= proc->tr_plazo_abs;
+		paux=paux->siguiente);
+	proc->siguiente=paux->siguiente;
+	paux->siguiente=proc;
+	if (lista->ultimo==paux)
+		lista->ultimo=proc;
+}
+
 /*
  *
- * Funciones relacionadas con la planificacion
- *	espera_int planificador
+ * Funciones que manejan el árbol rojinegro de listos del modo CFS (A6)
+ *	arbol_insertar arbol_eliminar
+ *
+ * Los nodos van dentro del BCP y a igualdad de vruntime se inserta a la
+ * derecha, de modo que se respeta el orden de llegada. Cada CPU virtual
+ * tiene su propio árbol (A10).
+ */
+
+static void rotar_izq(arbol_t *a, BCP *x){
+	BCP *y=x->arb_der;
+
+	x->arb_der=y->arb_izq;
+	if (y->arb_izq)
+		y->arb_izq->arb_padre=x;
+	y->arb_padre=x->arb_padre;
+	if (x->arb_padre==NULL)
+		a->raiz=y;
+	else if (x==x->arb_padre->arb_izq)
+		x->arb_padre->arb_izq=y;
+	else
+		x->arb_padre->arb_der=y;
+	y->arb_izq=x;
+	x->arb_padre=y;
+}
+
+static void rotar_der(arbol_t *a, BCP *x){
+	BCP *y=x->arb_izq;
+
+	x->arb_izq=y->arb_der;
+	if (y->arb_der)
+		y->arb_der->arb_padre=x;
+	y->arb_padre=x->arb_padre;
+	if (x->arb_padre==NULL)
+		a->raiz=y;
+	else if (x==x->arb_padre->arb_der)
+		x->arb_padre->arb_der=y;
+	else
+		x->arb_padre->arb_izq=y;
+	y->arb_der=x;
+	x->arb_padre=y;
+}
+
+static int es_negro(BCP *x){
+	return (x==NULL || x->arb_color==NEGRO);
+}
+
+/*
+ * Inserta un BCP en el árbol según su vruntime.
  */
+static void arbol_insertar(arbol_t *a, BCP *z){
+	BCP *y=NULL, *x=a->raiz, *p, *g, *t;
+	int es_minimo=1;
+
+	while (x) {
+		y=x;
+		if (z->vruntime < x->vruntime)
+			x=x->arb_izq;
+		else {
+			x=x->arb_der;
+			es_minimo=0;
+		}
+	}
+	z->arb_padre=y;
+	z->arb_izq=z->arb_der=NULL;
+	z->arb_color=ROJO;
+	if (y==NULL)
+		a->raiz=z;
+	else if (z->vruntime < y->vruntime)
+		y->arb_izq=z;
+	else
+		y->arb_der=z;
+	if (es_minimo)
+		a->primero=z;
+
+	/* restaura las propiedades del árbol */
+	while (z->arb_padre && z->arb_padre->arb_color==ROJO) {
+		p=z->arb_padre;
+		g=p->arb_padre;
+		if (p==g->arb_izq) {
+			t=g->arb_der;
+			if (!es_negro(t)) {
+				p->arb_color=NEGRO;
+				t->arb_color=NEGRO;
+				g->arb_color=ROJO;
+				z=g;
+			}
+			else {
+				if (z==p->arb_der) {
+					z=p;
+					rotar_izq(a, z);
+					p=z->arb_padre;
+				}
+				p->arb_color=NEGRO;
+				g->arb_color=ROJO;
+				rotar_der(a, g);
+			}
+		}
+		else {
+			t=g->arb_izq;
+			if (!es_negro(t)) {
+				p->arb_color=NEGRO;
+				t->arb_color=NEGRO;
+				g->arb_color=ROJO;
+				z=g;
+			}
+			else {
+				if (z==p->arb_izq) {
+					z=p;
+					rotar_der(a, z);
+					p=z->arb_padre;
+				}
+				p->arb_color=NEGRO;
+				g->arb_color=ROJO;
+				rotar_izq(a, g);
+			}
+		}
+	}
+	a->raiz->arb_color=NEGRO;
+}
 
 /*
- * Espera a que se produzca una interrupcion
+ * Sustituye en el árbol el subárbol u por el v.
  */
-static void espera_int(){
+static void arbol_trasplantar(arbol_t *a, BCP *u, BCP *v){
+	if (u->arb_padre==NULL)
+		a->raiz=v;
+	else if (u==u->arb_padre->arb_izq)
+		u->arb_padre->arb_izq=v;
+	else
+		u->arb_padre->arb_der=v;
+	if (v)
+		v->arb_padre=u->arb_padre;
+}
+
+static BCP * arbol_minimo(BCP *x){
+	while (x->arb_izq)
+		x=x->arb_izq;
+	return x;
+}
+
+static BCP * arbol_maximo(BCP *x){
+	while (x->arb_der)
+		x=x->arb_der;
+	return x;
+}
+
+/*
+ * Elimina un BCP del árbol.
+ */
+static void arbol_eliminar(arbol_t *a, BCP *z){
+	BCP *y=z, *x, *x_padre, *w;
+	int color_y=y->arb_color;
+
+	if (z==a->primero) /* el mínimo no tiene hijo izquierdo */
+		a->primero=z->arb_der ? arbol_minimo(z->arb_der) : z->arb_padre;
+
+	if (z->arb_izq==NULL) {
+		x=z->arb_der;
+		x_padre=z->arb_padre;
+		arbol_trasplantar(a, z, z->arb_der);
+	}
+	else if (z->arb_der==NULL) {
+		x=z->arb_izq;
+		x_padre=z->arb_padre;
+		arbol_trasplantar(a, z, z->arb_izq);
+	}
+	else {
+		y=arbol_minimo(z->arb_der);
+		color_y=y->arb_color;
+		x=y->arb_der;
+		if (y->arb_padre==z)
+			x_padre=y;
+		else {
+			x_padre=y->arb_padre;
+			arbol_trasplantar(a, y, y->arb_der);
+			y->arb_der=z->arb_der;
+			y->arb_der->arb_padre=y;
+		}
+		arbol_trasplantar(a, z, y);
+		y->arb_izq=z->arb_izq;
+		y->arb_izq->arb_padre=y;
+		y->arb_color=z->arb_color;
+	}
+	if (color_y==ROJO)
+		return;
+
+	/* se ha quitado un nodo negro: restaura las propiedades del árbol */
+	while (x!=a->raiz && es_negro(x)) {
+		if (x==x_padre->arb_izq) {
+			w=x_padre->arb_der;
+			if (!es_negro(w)) {
+				w->arb_color=NEGRO;
+				x_padre->arb_color=ROJO;
+				rotar_izq(a, x_padre);
+				w=x_padre->arb_der;
+			}
+			if (es_negro(w->arb_izq) && es_negro(w->arb_der)) {
+				w->arb_color=ROJO;
+				x=x_padre;
+				x_padre=x->arb_padre;
+			}
+			else {
+				if (es_negro(w->arb_der)) {
+					w->arb_izq->arb_color=NEGRO;
+					w->arb_color=ROJO;
+					rotar_der(a, w);
+					w=x_padre->arb_der;
+				}
+				w->arb_color=x_padre->arb_color;
+				x_padre->arb_color=NEGRO;
+				w->arb_der->arb_color=NEGRO;
+				rotar_izq(a, x_padre);
+				x=a->raiz;
+			}
+		}
+		else {
+			w=x_padre->arb_izq;
+			if (!es_negro(w)) {
+				w->arb_color=NEGRO;
+				x_padre->arb_color=ROJO;
+				rotar_der(a, x_padre);
+				w=x_padre->arb_izq;
+			}
+			if (es_negro(w->arb_der) && es_negro(w->arb_izq)) {
+				w->arb_color=ROJO;
+				x=x_padre;
+				x_padre=x->arb_padre;
+			}
+			else {
+				if (es_negro(w->arb_izq)) {
+					w->arb_der->arb_color=NEGRO;
+					w->arb_color=ROJO;
+					rotar_izq(a, w);
+					w=x_padre->arb_izq;
+				}
+				w->arb_color=x_padre->arb_color;
+				x_padre->arb_color=NEGRO;
+				w->arb_izq->arb_color=NEGRO;
+				rotar_der(a, x_padre);
+				x=a->raiz;
+			}
+		}
+	}
+	if (x)
+		x->arb_color=NEGRO;
+}
+
+/*
+ *
+ * Funciones de la rueda de temporización de dormidos (A13)
+ *	rueda_insertar rueda_eliminar rueda_avanzar rueda_proximo rueda_agrupar
+ *
+ */
+
+/*
+ * Inserta un proceso en la rueda según su tick de despertar. Si ya ha
+ * vencido, despertará en el siguiente tick.
+ */
+static void rueda_insertar(BCP * proc){
+	unsigned long plazo;
+	int nivel=0;
+	BCP **ranura;
+
+	if (proc->despertar < base_rueda)
+		proc->despertar=base_rueda;
+	plazo=proc->despertar-base_rueda;
+	if (plazo >= 1UL<<(BITS_RUEDA*NIVELES_RUEDA)) { /* fuera de alcance */
+		plazo=(1UL<<(BITS_RUEDA*NIVELES_RUEDA))-1;
+		proc->despertar=base_rueda+plazo;
+	}
+	while (plazo >= 1UL<<(BITS_RUEDA*(nivel+1)))
+		nivel++;
+	ranura=&rueda_dormidos[nivel]
+		[(proc->despertar>>(BITS_RUEDA*nivel))&(RANURAS_RUEDA-1)];
+
+	proc->rueda_ant=NULL;
+	proc->rueda_sig=*ranura;
+	if (*ranura)
+		(*ranura)->rueda_ant=proc;
+	*ranura=proc;
+	proc->rueda_ranura=ranura;
+	num_rueda[nivel]++;
+}
+
+/*
+ * Quita un proceso de la rueda
+ */
+static void rueda_eliminar(BCP * proc){
+	int nivel=(proc->rueda_ranura-&rueda_dormidos[0][0])/RANURAS_RUEDA;
+
+	if (proc->rueda_ant)
+		proc->rueda_ant->rueda_sig=proc->rueda_sig;
+	else
+		*proc->rueda_ranura=proc->rueda_sig;
+	if (proc->rueda_sig)
+		proc->rueda_sig->rueda_ant=proc->rueda_ant;
+	proc->rueda_ranura=NULL;
+	num_rueda[nivel]--;
+}
+
+/*
+ * Procesa el tick ticks_sistema: si el nivel 0 empieza vuelta, reparte
+ * las ranuras que tocan de los niveles superiores, y devuelve la lista
+ * (enlazada por rueda_sig) de los procesos que despiertan en él.
+ */
+static BCP * rueda_avanzar(){
+	unsigned long t=ticks_sistema;
 	int nivel;
+	BCP *proc, *sig, *vencidos=NULL;
+	BCP **ranura;
+
+	for (nivel=1; nivel<NIVELES_RUEDA &&
+	     ((t>>(BITS_RUEDA*(nivel-1)))&(RANURAS_RUEDA-1))==0; nivel++) {
+		ranura=&rueda_dormidos[nivel][(t>>(BITS_RUEDA*nivel))&(RANURAS_RUEDA-1)];
+		for (proc=*ranura; proc; proc=sig) {
+			sig=proc->rueda_sig;
+			rueda_eliminar(proc);
+			rueda_insertar(proc);
+		}
+	}
+	base_rueda=t+1;
+	ranura=&rueda_dormidos[0][t&(RANURAS_RUEDA-1)];
+	while ((proc=*ranura)) {
+		rueda_eliminar(proc);
+		proc->rueda_sig=vencidos;
+		vencidos=proc;
+	}
+	return vencidos;
+}
 
-	printk("-> NO HAY LISTOS. ESPERA INT\n");
+/*
+ * Devuelve cuántos ticks faltan, como mucho max, para el siguiente
+ * despertar o reparto de una ranura no vacía de la rueda
+ */
+static int rueda_proximo(int max){
+	int i, nivel;
+	unsigned long bloque, tick, t=max;
+
+	for (i=0; i<max && i<RANURAS_RUEDA; i++)
+		if (rueda_dormidos[0][(base_rueda+i)&(RANURAS_RUEDA-1)]) {
+			t=i+1;
+			break;
+		}
+	for (nivel=1; nivel<NIVELES_RUEDA; nivel++) {
+		if (num_rueda[nivel]==0)
+			continue;
+		/* la ranura del bloque j se reparte al llegar a su inicio */
+		bloque=base_rueda>>(BITS_RUEDA*nivel);
+		for (i=0; i<=RANURAS_RUEDA; i++) {
+			tick=(bloque+i)<<(BITS_RUEDA*nivel);
+			if (tick<base_rueda)
+				continue;
+			if (rueda_dormidos[nivel][(bloque+i)&(RANURAS_RUEDA-1)]) {
+				if (tick-ticks_sistema < t)
+					t=tick-ticks_sistema;
+				break;
+			}
+		}
+	}
+	return t;
+}
 
-	/* Baja al m�nimo el nivel de interrupci�n mientras espera */
-	nivel=fijar_nivel_int(NIVEL_1);
-	halt();
+/* A16
+ * Elige el tick de despertar entre primero y ultimo, ambos incluidos,
+ * para agrupar despertares: uno en el que ya despierte algún proceso o,
+ * si no lo hay, el más alineado (el múltiplo de la mayor potencia de 2),
+ * que es el que también elegirán otros procesos con ventanas parecidas.
+ */
+static unsigned long rueda_agrupar(unsigned long primero, unsigned long ultimo){
+	unsigned long t;
+	int b;
+
+	if (ultimo <= primero)
+		return primero;
+	for (t=primero; t<=ultimo && t<base_rueda+RANURAS_RUEDA; t++)
+		if (t>=base_rueda && rueda_dormidos[0][t&(RANURAS_RUEDA-1)])
+			return t;
+	for (b=0; b<8*(int)sizeof(t)-1 && ((ultimo>>(b+1))<<(b+1))>=primero; b++)
+		;
+	return (ultimo>>b)<<b;
+}
+
+/*
+ *
+ * Funciones del reloj dinámico (A12)
+ *	ticks_transcurridos us_desde_tick tiempo_monotono programar_reloj
+ *	reloj_periodico num_listos proximo_temporizador ticks_hasta_evento
+ *	ajustar_reloj
+ *
+ */
+
+/*
+ * Devuelve los ticks enteros transcurridos desde el inicio del periodo
+ * de reloj actual
+ */
+static int ticks_transcurridos(){
+	struct timespec ahora;
+
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return ((ahora.tv_sec-ultimo_tick.tv_sec)*1000000000L+
+		ahora.tv_nsec-ultimo_tick.tv_nsec)/(1000000000L/TICK);
+}
+
+/* A14
+ * Devuelve los microsegundos transcurridos desde el tick ticks_sistema,
+ * sin llegar al instante en que se contará el siguiente, para que el
+ * reloj monótono no retroceda.
+ */
+static unsigned long us_desde_tick(){
+	struct timespec ahora;
+	long us;
+
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	us=(ahora.tv_sec-ultimo_tick.tv_sec)*1000000L+
+		(ahora.tv_nsec-ultimo_tick.tv_nsec)/1000;
+	if (us<0)
+		us=0;
+	if (us>=(long)ticks_por_int*US_POR_TICK)
+		us=(long)ticks_por_int*US_POR_TICK-1;
+	return us;
+}
+
+/* A15
+ * Devuelve el instante actual del reloj monótono. El tick k empieza en
+ * el instante k*US_POR_TICK.
+ */
+static unsigned long long tiempo_monotono(){
+	unsigned long long t;
+	int nivel;
+
+	nivel=fijar_nivel_int(NIVEL_3); /* que no se cuente un tick a medias */
+	t=(unsigned long long)(ticks_sistema+ticks_pendientes)*US_POR_TICK+
+		us_desde_tick();
 	fijar_nivel_int(nivel);
+	return t;
 }
 
 /*
- * Funci�n de planificacion que implementa un algoritmo FIFO.
+ * Programa el reloj para que interrumpa cada ticks ticks
  */
-static BCP * planificador(){
-	while (lista_listos.primero==NULL)
-		espera_int();		/* No hay nada que hacer */
-	return lista_listos.primero;
+static void programar_reloj(int ticks){
+	ticks_por_int=ticks;
+	iniciar_cont_reloj(TICK/ticks);
+	clock_gettime(CLOCK_MONOTONIC, &ultimo_tick);
+}
+
+static void procesar_tick();
+
+/*
+ * Vuelve a interrumpir en cada tick si se estaba en un periodo largo,
+ * porque hay un nuevo evento temporal o el proceso actual deja de
+ * ejecutar. Los ticks que ya han pasado del periodo se procesan ahora,
+ * de modo que se cargan al proceso que los ha consumido.
+ */
+static void reloj_periodico(){
+	int n, nivel;
+
+	if (ticks_por_int==1)
+		return;
+	n=ticks_transcurridos();
+	programar_reloj(1);
+	nivel=fijar_nivel_int(NIVEL_3);
+	while (n-- > 0)
+		procesar_tick();
+	fijar_nivel_int(nivel);
+}
+
+/*
+ * Devuelve el número de procesos listos en todas las CPUs
+ */
+static int num_listos(){
+	int i, n=0;
+	BCP *proc;
+
+	for (i=0; i<num_cpus; i++)
+		n+=tabla_cpus[i].nlistos;
+	for (proc=cola_tr.primero; proc; proc=proc->siguiente)
+		n++;
+	return n;
+}
+
+/*
+ * Devuelve cuántos ticks faltan, como mucho max, para el siguiente
+ * evento temporal previsto que no depende de quién ejecuta: despertares,
+ * activaciones y plazos de tiempo real y recarga de grupos limitados.
+ */
+static int proximo_temporizador(int max){
+	int t;
+	BCP *proc;
+
+	t=rueda_proximo(max);
+	for (proc=procs_tr; proc; proc=proc->sig_tr) {
+		if ((long)(proc->tr_sig_activacion-ticks_sistema) < t)
+			t=proc->tr_sig_activacion-ticks_sistema;
+		if (proc->tr_pendiente &&
+		    (long)(proc->tr_plazo_abs-ticks_sistema) < t)
+			t=proc->tr_plazo_abs-ticks_sistema;
+	}
+	if (lista_limitados.primero && ticks_hasta_recarga < t)
+		t=ticks_hasta_recarga;
+	return t;
+}
+
+/*
+ * Devuelve cuántos ticks pueden pasar sin interrupción de reloj: uno si
+ * hay varios procesos listos que se reparten el procesador y, si no,
+ * hasta el siguiente evento temporal previsto.
+ */
+static int ticks_hasta_evento(){
+	int t, n, g, resto;
+	Grupo *gr;
+
+	n=num_listos();
+	if (n>1 || (n==1 && p_proc_actual->estado!=LISTO))
+		return 1;
+	t=proximo_temporizador(TICK);
+	if (n==1 && p_proc_actual->clase==CLASE_TR &&
+	    p_proc_actual->tr_restante < t)
+		t=p_proc_actual->tr_restante;
+	if (n==1 && p_proc_actual->clase==CLASE_NORMAL)
+		for (g=p_proc_actual->grupo; g!=-1; g=gr->padre) {
+			gr=&tabla_grupos[g];
+			resto=gr->cuota-gr->usados;
+			if (gr->cuota && resto < t)
+				t=resto;
+		}
+	if (t<1)
+		t=1;
+	while (TICK%t) /* que la frecuencia sea entera */
+		t--;
+	return t;
+}
+
+/*
+ * Reprograma el reloj según los procesos listos y los eventos previstos
+ */
+static void ajustar_reloj(){
+	int t;
+
+	if (!reloj_dinamico)
+		return;
+	t=ticks_hasta_evento();
+	if (t!=ticks_por_int)
+		programar_reloj(t);
+}
+
+/*
+ *
+ * Políticas de planificación (A8)
+ *
+ * Cada política es un módulo con las operaciones de planificar_t (ver
+ * kernel.h) y se elige en el arranque buscando su nombre en
+ * tabla_politicas. Las operaciones sólo ven procesos de la clase normal:
+ * los de tiempo real los gestiona la clase EDF por delante de ellas.
+ *
+ */
+
+/*
+ *
+ * Colas multinivel compartidas por FIFO, RR, PRIO y MLFQ
+ *	colas_encolar colas_desencolar colas_elegir colas_expulsa
+ *
+ * Cada CPU tiene una cola FIFO por nivel y el bit i de su mapa_listos
+ * indica si la cola i tiene algún proceso, de manera que el primer listo
+ * se obtiene en O(1) con una búsqueda del primer bit activo.
+ */
+
+/*
+ * Inserta un BCP al final de la cola de su nivel en su CPU.
+ */
+void colas_encolar(BCP * proc){
+	cpu_t *cpu=&tabla_cpus[proc->cpu];
+
+	insertar_ultimo(&cpu->colas_listos[proc->nivel], proc);
+	cpu->mapa_listos|=(1U << proc->nivel);
+}
+
+/*
+ * Elimina un BCP de la cola de su nivel en su CPU.
+ */
+void colas_desencolar(BCP * proc){
+	cpu_t *cpu=&tabla_cpus[proc->cpu];
+	lista_BCPs *cola=&cpu->colas_listos[proc->nivel];
+
+	eliminar_elem(cola, proc);
+	if (cola->primero==NULL)
+		cpu->mapa_listos&=~(1U << proc->nivel);
+}
+
+/*
+ * Devuelve el primer proceso del nivel más prioritario no vacío de la
+ * CPU actual.
+ */
+BCP * colas_elegir(){
+	cpu_t *cpu=&tabla_cpus[cpu_actual];
+
+	if (cpu->mapa_listos==0)
+		return NULL;
+	return cpu->colas_listos[__builtin_ffs(cpu->mapa_listos)-1].primero;
+}
+
+/*
+ * Un proceso expulsa al actual si está en un nivel más prioritario.
+ */
+int colas_expulsa(BCP * proc){
+	return (proc->nivel < p_proc_actual->nivel);
+}
+
+/*
+ * El proceso cede el procesador: pasa al final de su cola conservando lo
+ * que le queda de rodaja.
+ */
+void colas_ceder(BCP * proc){
+	colas_desencolar(proc);
+	colas_encolar(proc);
+}
+
+/*
+ * Pasa el proceso actual al final de su cola con una rodaja nueva.
+ */
+static void rotar(BCP * proc, int rodaja){
+	colas_desencolar(proc);
+	colas_encolar(proc);
+	proc->ticks=rodaja;
+}
+
+/*
+ *
+ * Política FIFO: una sola cola y sin expulsión
+ *	fifo_iniciar fifo_tick fifo_expulsa
+ *
+ */
+void fifo_iniciar(BCP * proc){
+	proc->nivel=0;
+}
+
+int fifo_tick(BCP * proc){
+	return 0;
+}
+
+int fifo_expulsa(BCP * proc){
+	return 0;
+}
+
+/*
+ *
+ * Política RR: una sola cola con turno rotatorio (A3)
+ *	rr_iniciar rr_tick rr_despertar
+ *
+ */
+void rr_iniciar(BCP * proc){
+	proc->nivel=0;
+	proc->ticks=TICKS_POR_RODAJA;
+}
+
+/*
+ * Descuenta un tick de la rodaja. Al agotarse pasa al final de su cola.
+ * También la usa PRIO, en la que la cola es la de su prioridad.
+ */
+int rr_tick(BCP * proc){
+	if (proc==NULL || --proc->ticks > 0)
+		return 0;
+	rotar(proc, TICKS_POR_RODAJA);
+	return 1;
+}
+
+void rr_despertar(BCP * proc){
+	proc->ticks=TICKS_POR_RODAJA;
+}
+
+/*
+ *
+ * Política PRIO: prioridades fijas con turno rotatorio en cada nivel (A4)
+ *	prio_iniciar
+ *
+ */
+void prio_iniciar(BCP * proc){
+	proc->nivel=proc->prioridad;
+	proc->ticks=TICKS_POR_RODAJA;
+}
+
+/*
+ *
+ * Política MLFQ: colas multinivel con realimentación (A5)
+ *	mlfq_iniciar mlfq_tick mlfq_bloquear
+ *
+ * El nivel de un proceso varía entre su prioridad y NUM_PRIORIDADES-1:
+ * baja cuando agota su rodaja y sube cuando se bloquea habiendo usado
+ * menos de la mitad. La rodaja crece con el nivel. Cada PERIODO_BOOST
+ * ticks todos los procesos vuelven al nivel de su prioridad.
+ */
+static int mlfq_rodaja(int nivel){
+	return (TICKS_POR_RODAJA/2)*(nivel+1);
+}
+
+void mlfq_iniciar(BCP * proc){
+	proc->nivel=proc->prioridad;
+	proc->ticks=mlfq_rodaja(proc->nivel);
+}
+
+/*
+ * Devuelve todos los procesos al nivel de su prioridad para que ninguno
+ * se quede sin ejecutar en los niveles bajos.
+ */
+static void subir_niveles(){
+	int i;
+	BCP *proc;
+
+	for (i=0; i<tam_tabla_procs; i++) {
+		proc=BCP_TABLA(i);
+		if (proc->estado==NO_USADA || proc->nivel==proc->prioridad)
+			continue;
+		if (proc->estado==LISTO && proc->clase==CLASE_NORMAL) {
+			colas_desencolar(proc);
+			proc->nivel=proc->prioridad;
+			colas_encolar(proc);
+		}
+		else
+			proc->nivel=proc->prioridad;
+		proc->ticks=mlfq_rodaja(proc->nivel);
+	}
+}
+
+int mlfq_tick(BCP * proc){
+	int replanificar=0;
+
+	if (--ticks_hasta_boost <= 0) {
+		ticks_hasta_boost=PERIODO_BOOST;
+		subir_niveles();
+		replanificar=1;
+	}
+	if (proc==NULL || --proc->ticks > 0)
+		return replanificar;
+	/* ha usado toda la rodaja: baja de nivel */
+	colas_desencolar(proc);
+	if (proc->nivel < NUM_PRIORIDADES-1)
+		proc->nivel++;
+	colas_encolar(proc);
+	proc->ticks=mlfq_rodaja(proc->nivel);
+	return 1;
+}
+
+/*
+ * Si ha usado menos de media rodaja se considera interactivo y sube de
+ * nivel; si no, conserva lo que le queda de rodaja para que bloquearse
+ * justo antes de agotarla no le sirva para quedarse en el nivel.
+ */
+void mlfq_bloquear(BCP * proc){
+	if (proc->ticks > mlfq_rodaja(proc->nivel)/2 &&
+	    proc->nivel > proc->prioridad) {
+		proc->nivel--;
+		proc->ticks=mlfq_rodaja(proc->nivel);
+	}
+}
+
+/*
+ *
+ * Política CFS: reparto equitativo por tiempo virtual (A6)
+ *	cfs_iniciar cfs_encolar cfs_desencolar cfs_elegir cfs_tick
+ *	cfs_despertar cfs_expulsa
+ *
+ */
+void cfs_iniciar(BCP * proc){
+	cpu_t *cpu=&tabla_cpus[proc->cpu];
+
+	if (proc->vruntime < cpu->min_vruntime) /* empieza sin ventaja */
+		proc->vruntime=cpu->min_vruntime;
+}
+
+void cfs_encolar(BCP * proc){
+	arbol_insertar(&tabla_cpus[proc->cpu].arbol, proc);
+}
+
+void cfs_desencolar(BCP * proc){
+	arbol_eliminar(&tabla_cpus[proc->cpu].arbol, proc);
+}
+
+BCP * cfs_elegir(){
+	return tabla_cpus[cpu_actual].arbol.primero;
+}
+
+/*
+ * Carga un tick al proceso actual y lo recoloca en el árbol. Devuelve 1
+ * si otro proceso ha acumulado suficiente ventaja como para expulsarlo.
+ */
+int cfs_tick(BCP * proc){
+	cpu_t *cpu;
+	BCP *primero;
+
+	if (proc==NULL)
+		return 0;
+	cpu=&tabla_cpus[proc->cpu];
+	arbol_eliminar(&cpu->arbol, proc);
+	proc->vruntime+=
+		(unsigned long long)VRUNTIME_TICK*PESO_NORMAL/pesos_prioridad[proc->prioridad];
+	arbol_insertar(&cpu->arbol, proc);
+
+	primero=cpu->arbol.primero;
+	if (primero->vruntime > cpu->min_vruntime)
+		cpu->min_vruntime=primero->vruntime;
+	return (primero!=proc &&
+		proc->vruntime > primero->vruntime+CFS_GRANULARIDAD);
+}
+
+/*
+ * El crédito acumulado mientras dormía está acotado.
+ */
+void cfs_despertar(BCP * proc){
+	unsigned long long min_vruntime=tabla_cpus[proc->cpu].min_vruntime;
+
+	if (proc->vruntime+CFS_LATENCIA/2 < min_vruntime)
+		proc->vruntime=min_vruntime-CFS_LATENCIA/2;
+}
+
+int cfs_expulsa(BCP * proc){
+	return (proc->vruntime+CFS_GRANULARIDAD < p_proc_actual->vruntime);
+}
+
+/*
+ * El proceso cede el procesador: iguala su vruntime con el del último
+ * del árbol, de modo que pasa detrás de todos los listos de su CPU.
+ */
+void cfs_ceder(BCP * proc){
+	cpu_t *cpu=&tabla_cpus[proc->cpu];
+	BCP *ultimo=arbol_maximo(cpu->arbol.raiz);
+
+	if (ultimo==proc)
+		return;
+	arbol_eliminar(&cpu->arbol, proc);
+	proc->vruntime=ultimo->vruntime;
+	arbol_insertar(&cpu->arbol, proc);
+}
+
+/*
+ * Busca una política por su nombre. Devuelve NULL si no existe.
+ */
+static planificar_t * buscar_politica(char *nombre){
+	int i;
+
+	for (i=0; i<NUM_POLITICAS; i++)
+		if (strcmp(tabla_politicas[i].nombre, nombre)==0)
+			return &tabla_politicas[i];
+	return NULL;
+}
+
+/*
+ *
+ * Funciones que manejan el conjunto de procesos listos
+ *	insertar_listo eliminar_listo primer_listo debe_expulsar
+ *
+ * Los procesos de tiempo real van en la cola EDF y el resto en la
+ * estructura de la política activa de la CPU a la que pertenecen.
+ */
+
+/*
+ * Inserta un BCP entre los listos.
+ */
+static void insertar_listo(BCP * proc){
+	if (proc->clase==CLASE_TR) {
+		if (proc->tr_restante>0) /* si lo ha agotado, espera al periodo */
+			insertar_por_plazo(&cola_tr, proc);
+		return;
+	}
+	politica->encolar(proc);
+	contar_listo(proc, 1);
+	tabla_cpus[proc->cpu].nlistos++;
+	if (ticks_por_int>1 && num_listos()>1) /* A12: ya hay que repartir */
+		reloj_periodico();
+}
+
+/*
+ * Elimina un BCP de entre los listos.
+ */
+static void eliminar_listo(BCP * proc){
+	if (proc->clase==CLASE_TR) {
+		eliminar_elem(&cola_tr, proc);
+		return;
+	}
+	politica->desencolar(proc);
+	contar_listo(proc, -1);
+	tabla_cpus[proc->cpu].nlistos--;
+}
+
+/*
+ * Devuelve el proceso de tiempo real con plazo más próximo o, si no hay,
+ * el que elija la política activa en la CPU actual. Los de tiempo real
+ * sólo se ejecutan en la CPU 0.
+ */
+static BCP * primer_listo(){
+	if (cpu_actual==0 && cola_tr.primero) /* van por delante */
+		return cola_tr.primero;
+	return politica->elegir();
+}
+
+/*
+ * Indica si un proceso que pasa a listo debe expulsar al actual.
+ */
+static int debe_expulsar(BCP * proc){
+	if (p_proc_actual==NULL || p_proc_actual->estado!=LISTO)
+		return 0;
+	/* en otra CPU se elegirá cuando le toque ejecutar */
+	if ((proc->clase==CLASE_TR ? 0 : proc->cpu)!=cpu_actual)
+		return 0;
+	if (proc->clase==CLASE_TR)
+		return (proc->tr_restante>0 &&
+			(p_proc_actual->clase!=CLASE_TR ||
+			 proc->tr_plazo_abs < p_proc_actual->tr_plazo_abs));
+	if (p_proc_actual->clase==CLASE_TR)
+		return 0;
+	return politica->expulsa(proc);
+}
+
+/*
+ *
+ * Funciones de las CPUs virtuales (A10)
+ *	iniciar_cpus cpu_con_trabajo siguiente_cpu cpu_menos_cargada
+ *	migrar_proceso robar_trabajo
+ *
+ */
+
+/*
+ * Función que inicia las CPUs virtuales sin procesos
+ */
+static void iniciar_cpus(){
+	int i, j;
+	cpu_t *cpu;
+
+	for (i=0; i<MAX_CPUS; i++) {
+		cpu=&tabla_cpus[i];
+		cpu->actual=NULL;
+		for (j=0; j<NUM_PRIORIDADES; j++)
+			cpu->colas_listos[j].primero=cpu->colas_listos[j].ultimo=NULL;
+		cpu->mapa_listos=0;
+		cpu->arbol.raiz=cpu->arbol.primero=NULL;
+		cpu->min_vruntime=0;
+		cpu->nlistos=0;
+		cpu->cedido=NULL;
+		cpu->ticks_ocupada=cpu->ticks_ociosa=0;
+	}
+}
+
+/*
+ * Indica si una CPU tiene algún proceso listo
+ */
+static int cpu_con_trabajo(int c){
+	return (tabla_cpus[c].nlistos>0 || (c==0 && cola_tr.primero));
+}
+
+/*
+ * Devuelve la siguiente CPU con trabajo a partir de la actual, o la
+ * actual si no hay otra
+ */
+static int siguiente_cpu(){
+	int i, c;
+
+	for (i=1; i<num_cpus; i++) {
+		c=(cpu_actual+i)%num_cpus;
+		if (cpu_con_trabajo(c))
+			return c;
+	}
+	return cpu_actual;
+}
+
+/*
+ * Devuelve la CPU con menos procesos listos, donde se coloca un proceso
+ * nuevo
+ */
+static int cpu_menos_cargada(){
+	int i, c=0;
+
+	for (i=1; i<num_cpus; i++)
+		if (tabla_cpus[i].nlistos < tabla_cpus[c].nlistos)
+			c=i;
+	return c;
+}
+
+/*
+ * Pasa un proceso listo a la cola de otra CPU. El tiempo virtual se
+ * traslada respecto al mínimo de cada CPU para que no gane ni pierda.
+ */
+static void migrar_proceso(BCP * proc, int destino){
+	eliminar_listo(proc);
+	proc->vruntime=proc->vruntime-tabla_cpus[proc->cpu].min_vruntime+
+		tabla_cpus[destino].min_vruntime;
+	proc->cpu=destino;
+	insertar_listo(proc);
+}
+
+/*
+ * La CPU actual, que no tiene trabajo, roba un proceso listo que no esté
+ * ejecutando a la CPU más cargada. Devuelve 1 si lo consigue.
+ */
+static int robar_trabajo(){
+	int i, victima=-1;
+	BCP *proc;
+
+	for (i=0; i<num_cpus; i++)
+		if (i!=cpu_actual && tabla_cpus[i].nlistos>1 &&
+		    (victima==-1 || tabla_cpus[i].nlistos>tabla_cpus[victima].nlistos))
+			victima=i;
+	if (victima==-1)
+		return 0;
+	for (i=0; i<tam_tabla_procs; i++) {
+		proc=BCP_TABLA(i);
+		if (proc->estado==LISTO && proc->clase==CLASE_NORMAL &&
+		    proc->cpu==victima && proc!=tabla_cpus[victima].actual) {
+			printk("-> CPU %d: ROBA PROC %d A CPU %d\n",
+				cpu_actual, proc->id, victima);
+			migrar_proceso(proc, cpu_actual);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ *
+ * Funciones de la clase de tiempo real (A7)
+ *	tr_tick activar_periodos_tr salir_tiempo_real
+ *
+ */
+
+/*
+ * Descuenta un tick del presupuesto del proceso de tiempo real actual.
+ * Devuelve 1 si lo ha agotado y debe dejar el procesador.
+ */
+static int tr_tick(BCP * proc){
+	if (--proc->tr_restante > 0)
+		return 0;
+	eliminar_elem(&cola_tr, proc); /* queda aparcado hasta su periodo */
+	return 1;
+}
+
+/*
+ * Recorre los procesos de tiempo real anotando los plazos incumplidos y
+ * reponiendo el presupuesto de los que empiezan un nuevo periodo.
+ * Devuelve 1 si alguno de ellos debe expulsar al proceso actual.
+ */
+static int activar_periodos_tr(){
+	BCP *proc;
+	int expulsar=0;
+
+	for (proc=procs_tr; proc; proc=proc->sig_tr) {
+		if (proc->tr_pendiente && ticks_sistema >= proc->tr_plazo_abs) {
+			proc->tr_pendiente=0;
+			proc->tr_fallos++;
+			printk("-> PROC %d: PLAZO INCUMPLIDO (%d)\n",
+				proc->id, proc->tr_fallos);
+		}
+		if (ticks_sistema < proc->tr_sig_activacion)
+			continue;
+		if (proc->estado==LISTO)
+			eliminar_listo(proc);
+		proc->tr_restante=proc->tr_presupuesto;
+		proc->tr_plazo_abs=proc->tr_sig_activacion+proc->tr_plazo;
+		proc->tr_sig_activacion+=proc->tr_periodo;
+		if (proc->estado==LISTO) {
+			proc->tr_pendiente=1;
+			insertar_listo(proc);
+			if (proc!=p_proc_actual && debe_expulsar(proc))
+				expulsar=1;
+		}
+	}
+	return expulsar;
+}
+
+/*
+ * Devuelve un proceso a la clase normal liberando su reserva. Si está
+ * listo, el llamante debe haberlo sacado antes de la cola EDF.
+ */
+static void salir_tiempo_real(BCP * proc){
+	BCP **pp;
+
+	for (pp=&procs_tr; *pp!=proc; pp=&(*pp)->sig_tr);
+	*pp=proc->sig_tr;
+	utilizacion_tr-=proc->tr_util;
+	proc->clase=CLASE_NORMAL;
+}
+
+/*
+ *
+ * Funciones del trabajo diferido (A18)
+ *	diferir ejecutar_diferidos pedir_expulsion
+ *
+ * Los manejadores de interrupción sólo anotan el trabajo pendiente y
+ * activan la interrupción SW, en cuyo tratamiento se hace, a nivel 1, antes
+ * de volver a modo usuario. La interrupción SW sirve también para pedir
+ * una replanificación, que se anota aparte para distinguirla.
+ */
+
+/*
+ * Anota un trabajo diferido. Se llama desde los manejadores.
+ */
+static void diferir(int trabajo){
+	diferidos|=1U<<trabajo;
+	activar_int_SW();
+}
+
+/*
+ * Hace todos los trabajos diferidos pendientes, incluidos los que se
+ * anoten mientras tanto
+ */
+static void ejecutar_diferidos(){
+	unsigned int pendientes;
+	int i, nivel;
+
+	while (diferidos) {
+		nivel=fijar_nivel_int(NIVEL_3);
+		pendientes=diferidos;
+		diferidos=0;
+		fijar_nivel_int(nivel);
+		for (i=0; i<NUM_DIFERIDOS; i++)
+			if (pendientes & (1U<<i))
+				tabla_diferidos[i].funcion();
+	}
+}
+
+/*
+ * Pide que se replanifique al volver a modo usuario
+ */
+static void pedir_expulsion(){
+	expulsion_pendiente=1;
+	activar_int_SW();
+}
+
+/*
+ *
+ * Funciones de las tareas de fondo (A19)
+ *	hacer_trabajo_fondo tarea_limpiar_pilas obtener_pila devolver_pila
+ *	A23: clase_pila nueva_pila iniciar_pilas
+ *
+ * Cuando no hay nada listo, espera_int hace un trozo de alguna tarea de
+ * tabla_tareas_fondo antes de parar el procesador, y vuelve a mirar si
+ * hay algo listo entre un trozo y el siguiente.
+ */
+
+/*
+ * Hace un trozo de la siguiente tarea de fondo que tenga trabajo, con las
+ * interrupciones permitidas. Devuelve 0 si ninguna tenía.
+ */
+static int hacer_trabajo_fondo(){
+	int i, nivel, hecho=0;
+
+	nivel=fijar_nivel_int(NIVEL_1);
+	for (i=0; i<NUM_TAREAS_FONDO && !hecho; i++) {
+		turno_fondo=(turno_fondo+1)%NUM_TAREAS_FONDO;
+		hecho=tabla_tareas_fondo[turno_fondo].trozo();
+	}
+	fijar_nivel_int(nivel);
+	return hecho;
+}
+
+/*
+ * A23: devuelve la clase de pila más pequeña en la que caben tam bytes,
+ * o -1 si no cabe en ninguna
+ */
+static int clase_pila(unsigned int tam){
+	int c;
+
+	for (c=0; c<NUM_CLASES_PILA; c++)
+		if (TAM_CLASE_PILA(c)>=tam)
+			return c;
+	return -1;
+}
+
+/*
+ * A23: pide una pila nueva de la clase, con su página de guarda debajo.
+ * La memoria que da mmap ya viene a cero.
+ */
+static void * nueva_pila(int clase){
+	char *mem;
+
+	mem=mmap(NULL, TAM_GUARDA_PILA+TAM_CLASE_PILA(clase),
+		PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if (mem==MAP_FAILED)
+		return NULL;
+	if (mprotect(mem, TAM_GUARDA_PILA, PROT_NONE)<0) {
+		/* sin guarda un desbordamiento no llegaría a exc_mem */
+		munmap(mem, TAM_GUARDA_PILA+TAM_CLASE_PILA(clase));
+		return NULL;
+	}
+	return mem+TAM_GUARDA_PILA;
+}
+
+/*
+ * Tarea de fondo que pone a cero las pilas devueltas, un trozo cada vez,
+ * y las pasa a la reserva de limpias. Si no hay ninguna que limpiar y la
+ * reserva de algún tamaño está por debajo de lo que se quiere, pide una
+ * pila nueva. Nunca toca la del proceso actual, que puede estar
+ * terminando sobre ella.
+ */
+int tarea_limpiar_pilas(){
+	int i, c;
+	void *pila;
+	pila_sucia *p;
+
+	for (i=0; i<num_pilas_sucias; i++)
+		if (pilas_sucias[i].pila!=p_proc_actual->pila)
+			break;
+	if (i==num_pilas_sucias) {
+		if (num_pilas_sucias>0 || num_pilas_guardadas>=MAX_PILAS_FONDO)
+			return 0;
+		for (c=0; c<NUM_CLASES_PILA; c++)
+			if (num_pilas_limpias[c]<reserva_pilas[c]) {
+				if ((pila=nueva_pila(c))==NULL)
+					return 0;
+				pilas_limpias[c][num_pilas_limpias[c]++]=pila;
+				num_pilas_guardadas++;
+				return 1;
+			}
+		return 0;
+	}
+	p=&pilas_sucias[i];
+	memset((char *)p->pila+p->limpio, 0, TROZO_FONDO);
+	p->limpio+=TROZO_FONDO;
+	if (p->limpio>=TAM_CLASE_PILA(p->clase)) {
+		pilas_limpias[p->clase][num_pilas_limpias[p->clase]++]=p->pila;
+		*p=pilas_sucias[--num_pilas_sucias];
+	}
+	return 1;
+}
+
+/*
+ * Devuelve una pila de la clase para un proceso nuevo, de la reserva si
+ * hay alguna limpia. A23: la primera vez que se pide una clase se empieza
+ * a tener reserva de ella.
+ */
+static void * obtener_pila(int clase){
+	if (num_pilas_limpias[clase]>0) {
+		num_pilas_guardadas--;
+		return pilas_limpias[clase][--num_pilas_limpias[clase]];
+	}
+	reserva_pilas[clase]=RESERVA_PILAS;
+	return nueva_pila(clase);
+}
+
+/*
+ * Guarda la pila de un proceso que termina para limpiarla y reutilizarla.
+ * A23: si no hay sitio se libera, pero no en el momento, porque el
+ * proceso todavía está ejecutando sobre ella: se libera la que quedó
+ * pendiente la vez anterior y ésta queda pendiente.
+ */
+static void devolver_pila(void *pila, int clase){
+	if (num_pilas_guardadas>=MAX_PILAS_FONDO) {
+		if (pila_pendiente.pila)
+			munmap((char *)pila_pendiente.pila-TAM_GUARDA_PILA,
+				TAM_GUARDA_PILA+TAM_CLASE_PILA(pila_pendiente.clase));
+		pila_pendiente.pila=pila;
+		pila_pendiente.clase=clase;
+		return;
+	}
+	pilas_sucias[num_pilas_sucias].pila=pila;
+	pilas_sucias[num_pilas_sucias].clase=clase;
+	pilas_sucias[num_pilas_sucias++].limpio=0;
+	num_pilas_guardadas++;
+}
+
+/*
+ * A23: llena en el arranque la reserva de pilas del tamaño por defecto y
+ * hace que las excepciones de memoria se traten en pila_senales, para
+ * que el desbordamiento de una pila llegue a exc_mem. El manejador es el
+ * que ha puesto iniciar_cont_int; sólo se le añade SA_ONSTACK.
+ */
+static void iniciar_pilas(){
+	stack_t pila_alt;
+	struct sigaction accion;
+	int c=clase_pila(TAM_PILA);
+	void *pila;
+
+	reserva_pilas[c]=RESERVA_PILAS;
+	while (num_pilas_limpias[c]<RESERVA_PILAS) {
+		if ((pila=nueva_pila(c))==NULL)
+			break;	/* se seguirá llenando en ratos ociosos */
+		pilas_limpias[c][num_pilas_limpias[c]++]=pila;
+		num_pilas_guardadas++;
+	}
+
+	pila_alt.ss_sp=pila_senales;
+	pila_alt.ss_size=TAM_PILA_SENALES;
+	pila_alt.ss_flags=0;
+	sigaltstack(&pila_alt, NULL);
+	sigaction(SIGSEGV, NULL, &accion);
+	accion.sa_flags|=SA_ONSTACK;
+	sigaction(SIGSEGV, &accion, NULL);
+	sigaction(SIGBUS, NULL, &accion);
+	accion.sa_flags|=SA_ONSTACK;
+	sigaction(SIGBUS, &accion, NULL);
+}
+
+/*
+ *
+ * Funciones de la caché de imágenes (A22)
+ *	buscar_datos obtener_imagen descartar_imagen dejar_imagen soltar_imagen
+ *	poner_datos
+ *
+ */
+
+/*
+ * Función para dl_iterate_phdr: si el objeto es el que contiene el punto
+ * de entrada de la imagen, anota su zona escribible sin la parte RELRO,
+ * que el cargador deja de sólo lectura después de reubicar.
+ */
+static int buscar_datos(struct dl_phdr_info *info, size_t tam, void *arg){
+	imagen_prog *im=arg;
+	ElfW(Addr) dir=(ElfW(Addr))im->pc_inicial, base, ini=0, fin=0, relro=0;
+	const ElfW(Phdr) *ph;
+	int i, suya=0;
+
+	for (i=0; i<info->dlpi_phnum; i++) {
+		ph=&info->dlpi_phdr[i];
+		base=info->dlpi_addr+ph->p_vaddr;
+		if (ph->p_type==PT_LOAD && dir>=base && dir<base+ph->p_memsz)
+			suya=1;
+		if (ph->p_type==PT_LOAD && (ph->p_flags & PF_W)) {
+			ini=base;
+			fin=base+ph->p_memsz;
+		}
+		if (ph->p_type==PT_GNU_RELRO)
+			relro=base+ph->p_memsz;
+	}
+	if (!suya)
+		return 0;
+	if (relro>ini && relro<=fin)
+		ini=relro;
+	im->datos=(char *)ini;
+	im->tam_datos=fin-ini;
+	return 1;
+}
+
+/*
+ * Devuelve la imagen del programa con una referencia más, cargándola si
+ * no está en la caché. Devuelve NULL si no se puede cargar.
+ */
+static imagen_prog * obtener_imagen(char *prog){
+	imagen_prog *im, **ant;
+	unsigned int *tam_pila;
+
+	for (ant=&lista_imagenes; (im=*ant)!=NULL; ant=&im->siguiente)
+		if (strcmp(im->nombre, prog)==0) {
+			*ant=im->siguiente;
+			break;
+		}
+	if (im==NULL) {
+		if ((im=malloc(sizeof(imagen_prog)))==NULL)
+			return NULL;
+		if ((im->mem=crear_imagen(prog, &im->pc_inicial))==NULL) {
+			free(im);
+			return NULL;
+		}
+		/* A23: el programa puede pedir otro tamaño de pila */
+		tam_pila=dlsym(im->mem, "tam_pila");
+		im->clase_pila=clase_pila(tam_pila ? *tam_pila : TAM_PILA);
+		if (im->clase_pila<0) {
+			printk("-> %s PIDE UNA PILA DE %u BYTES, DEMASIADO GRANDE\n",
+				prog, *tam_pila);
+			liberar_imagen(im->mem);
+			free(im);
+			return NULL;
+		}
+		im->nrefs=0;
+		im->dueno=NULL;
+		im->datos=NULL;
+		im->tam_datos=0;
+		dl_iterate_phdr(buscar_datos, im);
+		/* sin datos no hace falta copia inicial (datos_ini queda NULL) */
+		im->datos_ini=NULL;
+		if ((im->nombre=strdup(prog))==NULL || (im->tam_datos &&
+		    (im->datos_ini=malloc(im->tam_datos))==NULL)) {
+			free(im->nombre);
+			liberar_imagen(im->mem);
+			free(im);
+			return NULL;
+		}
+		if (im->tam_datos)
+			memcpy(im->datos_ini, im->datos, im->tam_datos);
+		printk("-> CARGA IMAGEN %s (%lu BYTES DE DATOS)\n",
+			prog, (unsigned long)im->tam_datos);
+	}
+	else if (im->nrefs==0)
+		num_imagenes_sin_uso--;
+	im->siguiente=lista_imagenes;	/* la más reciente primero */
+	lista_imagenes=im;
+	im->nrefs++;
+	return im;
+}
+
+/*
+ * Saca una imagen de la caché y la libera. Si ya no queda ninguna, el
+ * HAL da por terminado el sistema.
+ */
+static void descartar_imagen(imagen_prog *im){
+	imagen_prog **ant;
+	void *mem=im->mem;
+
+	for (ant=&lista_imagenes; *ant!=im; ant=&(*ant)->siguiente);
+	*ant=im->siguiente;
+	free(im->nombre);
+	free(im->datos_ini);
+	free(im);
+	liberar_imagen(mem);
+}
+
+/*
+ * Quita una referencia a la imagen. Si se queda sin procesos pasa a estar
+ * sin uso, y si hay demasiadas se descarta la menos usada.
+ */
+static void dejar_imagen(imagen_prog *im){
+	imagen_prog *sin_uso=NULL;
+
+	if (--im->nrefs==0 && ++num_imagenes_sin_uso>MAX_IMAGENES_SIN_USO) {
+		for (im=lista_imagenes; im; im=im->siguiente)
+			if (im->nrefs==0)
+				sin_uso=im;
+		printk("-> DESCARTA IMAGEN %s\n", sin_uso->nombre);
+		num_imagenes_sin_uso--;
+		descartar_imagen(sin_uso);
+	}
+}
+
+/*
+ * Quita la referencia de un proceso que termina a su imagen. Con el
+ * último proceso se descartan todas.
+ */
+static void soltar_imagen(BCP *p){
+	imagen_prog *im=p->imagen;
+
+	if (im->dueno==p)
+		im->dueno=NULL;
+	free(p->datos);
+	procesos_vivos--;
+	dejar_imagen(im);
+	if (procesos_vivos==0)
+		while (lista_imagenes)
+			descartar_imagen(lista_imagenes);
+}
+
+/*
+ * Pone en la imagen de un proceso sus datos, guardando antes los del
+ * proceso que los tenía puestos. Se llama antes de pasar a ejecutarlo.
+ */
+static void poner_datos(BCP *p){
+	imagen_prog *im=p->imagen;
+
+	if (im->dueno==p->proceso || im->tam_datos==0) //A27: los hilos usan los de su proceso.
+		return;
+	if (im->dueno)
+		memcpy(im->dueno->datos, im->datos, im->tam_datos);
+	memcpy(im->datos, p->datos, im->tam_datos);
+	im->dueno=p->proceso;
+}
+
+/*
+ *
+ * Funciones relacionadas con la planificacion
+ *	espera_int planificador bloquear_proceso desbloquear_proceso
+ */
+
+/*
+ * Espera a que se produzca una interrupcion
+ */
+static void espera_int(){
+	int nivel, n;
+
+	/* A18: la int. SW está inhibida aquí; el trabajo pendiente se hace ya */
+	if (diferidos) {
+		ejecutar_diferidos();
+		return;
+	}
+
+	/* A19: aprovecha para adelantar trabajo de fondo */
+	if (hacer_trabajo_fondo())
+		return;
+
+	/* A17: con tiempo virtual se salta directamente al siguiente evento */
+	if (tiempo_virtual &&
+	    (n=proximo_temporizador(MAX_SALTO))<MAX_SALTO) {
+		reloj_periodico();
+		printk("-> NO HAY LISTOS. AVANZA %d TICKS\n", n);
+		nivel=fijar_nivel_int(NIVEL_3);
+		while (n-- > 0 && num_listos()==0) {
+			procesar_tick();
+			us_saltados+=US_POR_TICK;
+		}
+		/* el tick al que se salta empieza ahora */
+		clock_gettime(CLOCK_MONOTONIC, &ultimo_tick);
+		fijar_nivel_int(nivel);
+		return;
+	}
+
+	printk("-> NO HAY LISTOS. ESPERA INT\n");
+
+	/* Baja al m�nimo el nivel de interrupci�n mientras espera */
+	nivel=fijar_nivel_int(NIVEL_1);
+	halt();
+	fijar_nivel_int(nivel);
+	ejecutar_diferidos(); //A18
+}
+
+/*
+ * Funci�n de planificacion: EDF para los procesos de tiempo real y la
+ * política elegida en el arranque para el resto. Si la CPU actual no
+ * tiene trabajo, roba un proceso a otra o, si no puede, cede el turno a
+ * la siguiente CPU con trabajo (A10).
+ */
+static BCP * planificador(){
+	BCP *proc;
+	int c;
+
+	/* A11: si el actual ha cedido su turno, ejecuta el que lo recibe
+	   salvo que haya uno de tiempo real */
+	proc=tabla_cpus[cpu_actual].cedido;
+	tabla_cpus[cpu_actual].cedido=NULL;
+	if (proc && proc->estado==LISTO && proc->cpu==cpu_actual &&
+	    (cpu_actual!=0 || cola_tr.primero==NULL)) {
+		tabla_cpus[cpu_actual].actual=proc;
+		return proc;
+	}
+
+	while ((proc=primer_listo())==NULL) {
+		if (num_cpus>1) {
+			if (robar_trabajo())
+				continue;
+			if ((c=siguiente_cpu())!=cpu_actual) {
+				tabla_cpus[cpu_actual].actual=NULL;
+				cpu_actual=c;
+				continue;
+			}
+		}
+		espera_int();		/* No hay nada que hacer */
+	}
+	tabla_cpus[cpu_actual].actual=proc;
+	return proc;
+}
+
+/*
+ * Bloquea el proceso actual en la lista indicada (NULL si no espera en
+ * ninguna, como los dormidos) y cede el procesador al siguiente proceso
+ * listo.
+ */
+static void bloquear_proceso(lista_BCPs *lista){
+	BCP * p_proc_anterior;
+
+	reloj_periodico(); /* A12: se le cargan los ticks ya consumidos */
+	p_proc_anterior=p_proc_actual;
+	p_proc_actual->estado=BLOQUEADO;
+	eliminar_listo(p_proc_actual);
+	p_proc_actual->tr_pendiente=0; /* TR: al bloquearse completa la activación */
+	if (politica->bloquear)
+		politica->bloquear(p_proc_actual);
+	if (lista) /* A13: los dormidos están en la rueda */
+		insertar_ultimo(lista, p_proc_actual);
+	p_proc_actual->lista_bloqueo=lista; //A27
+
+	p_proc_actual=planificador();
+	if (p_proc_actual!=p_proc_anterior) //Puede haberse despertado durante la espera.
+	{
+		cambios_contexto++;
+		poner_datos(p_proc_actual); //A22: sus datos en la imagen.
+		cambio_contexto(p_proc_anterior->contexto_regs, p_proc_actual->contexto_regs);
+	}
+}
+
+/*
+ * Saca un proceso de la lista en la que estaba bloqueado (NULL si no
+ * estaba en ninguna) y lo pasa a listo. Si es más prioritario que el
+ * actual, fuerza su expulsión.
+ */
+static void desbloquear_proceso(lista_BCPs *lista, BCP * proc){
+	if (lista)
+		eliminar_elem(lista, proc);
+	proc->lista_bloqueo=NULL; //A27
+	if (proc->clase==CLASE_NORMAL && grupo_limitado(proc)) {
+		/* A9: sigue apartado hasta la siguiente ventana */
+		insertar_ultimo(&lista_limitados, proc);
+		proc->lista_bloqueo=&lista_limitados;
+		return;
+	}
+	proc->estado=LISTO;
+	if (politica->despertar)
+		politica->despertar(proc);
+	if (proc->clase==CLASE_TR && proc->tr_restante>0)
+		proc->tr_pendiente=1;
+	insertar_listo(proc);
+	if (debe_expulsar(proc))
+		pedir_expulsion();
+}
+
+/*
+ * Cede al proceso destino lo que le queda de rodaja al actual, de modo
+ * que sea el siguiente en ejecutar en esta CPU (A11). Sólo entre procesos
+ * de la clase normal. Devuelve -1 si el destino no puede recibirlo.
+ */
+static int ceder_turno(BCP * destino){
+	if (destino->estado!=LISTO || destino->clase!=CLASE_NORMAL ||
+	    p_proc_actual->clase!=CLASE_NORMAL)
+		return -1;
+	if (destino->cpu!=cpu_actual) {
+		if (tabla_cpus[destino->cpu].actual==destino)
+			return -1;	/* está ejecutando en otra CPU */
+		migrar_proceso(destino, cpu_actual);
+	}
+	destino->ticks=p_proc_actual->ticks;
+	tabla_cpus[cpu_actual].cedido=destino;
+	return 0;
+}
+
+/*
+ *
+ * Funciones de los grupos de reparto de CPU (A9)
+ *	aparcar_proceso aparcar_limitados cargar_tick_grupo recargar_grupos
+ *
+ */
+
+/*
+ * Aparta un proceso listo de un grupo limitado hasta la siguiente
+ * ventana. Se queda bloqueado en lista_limitados.
+ */
+static void aparcar_proceso(BCP * proc){
+	eliminar_listo(proc);
+	proc->estado=BLOQUEADO;
+	insertar_ultimo(&lista_limitados, proc);
+	proc->lista_bloqueo=&lista_limitados; //A27
+}
+
+/*
+ * Aparta todos los procesos listos de grupos limitados salvo el actual,
+ * que se aparta en int_sw al salir del núcleo por si la interrupción de
+ * reloj ha llegado en mitad de una llamada al sistema.
+ */
+static void aparcar_limitados(){
+	int i;
+	BCP *proc;
+
+	for (i=0; i<tam_tabla_procs; i++) {
+		proc=BCP_TABLA(i);
+		if (proc!=p_proc_actual && proc->estado==LISTO &&
+		    proc->clase==CLASE_NORMAL && grupo_limitado(proc))
+			aparcar_proceso(proc);
+	}
+}
+
+/*
+ * Carga un tick al grupo del proceso y a sus ancestros, y limita los que
+ * superan su cuota, o su reparto si hay procesos de otros grupos
+ * hermanos esperando. Devuelve 1 si ha limitado alguno.
+ */
+static int cargar_tick_grupo(BCP * proc){
+	int g, limitar=0;
+	Grupo *gr;
+
+	for (g=proc->grupo; g!=-1; g=gr->padre) {
+		gr=&tabla_grupos[g];
+		gr->usados++;
+		if (gr->limitado)
+			continue;
+		if ((gr->cuota && gr->usados>=gr->cuota) ||
+		    (gr->padre!=-1 && gr->usados>=gr->limite &&
+		     tabla_grupos[gr->padre].nlistos > gr->nlistos)) {
+			printk("-> GRUPO %d: LIMITADO CON %d TICKS\n",
+				g, gr->usados);
+			gr->limitado=1;
+			limitar=1;
+		}
+	}
+	if (limitar)
+		aparcar_limitados();
+	return limitar;
+}
+
+/*
+ * Empieza una ventana nueva: pone a cero el consumo de los grupos y
+ * devuelve a listos los procesos apartados.
+ */
+static void recargar_grupos(){
+	int i;
+
+	for (i=0; i<MAX_GRUPOS; i++) {
+		tabla_grupos[i].usados=0;
+		tabla_grupos[i].limitado=0;
+	}
+	while (lista_limitados.primero)
+		desbloquear_proceso(&lista_limitados, lista_limitados.primero);
+}
+
+/*
+ * A27: suelta los mutex que tenga cerrados un hilo que termina, que son
+ * de los descriptores de su proceso. Como en sis_unlock, cada uno pasa al
+ * primero que lo espere.
+ */
+static void soltar_cerrojos(BCP * p){
+	int i, id;
+	Mutex *mutex;
+	BCP *aux;
+
+	for (i = 0; i < NUM_MUT_PROC; i++)
+	{
+		id = p->proceso->descriptores_mutex[i];
+		if (id == -1 || tabla_mutex[id].proceso_bloqueador != p)
+			continue;
+		mutex = &tabla_mutex[id];
+		mutex->estado = MUT_DESBLOQUEADO;
+		mutex->veces_bloq = 0;
+		mutex->proceso_bloqueador = NULL;
+		if ((aux = mutex->procesos_bloqueados.primero) != NULL)
+		{
+			desbloquear_proceso(&mutex->procesos_bloqueados, aux);
+			mutex->proceso_bloqueador = aux;
+		}
+	}
+}
+
+/*
+ * A27: saca de la planificación un proceso o hilo que termina, sea el
+ * actual o no, y lo deja en lista_terminados. Si no es el actual puede
+ * estar listo o bloqueado en cualquier lista o en la rueda de dormidos.
+ */
+static void retirar_BCP(BCP * p, int estado){
+	int c, nivel;
+
+	if (p->estado==LISTO)
+		eliminar_listo(p);
+	else {
+		if (p->lista_bloqueo)
+			eliminar_elem(p->lista_bloqueo, p);
+		nivel=fijar_nivel_int(NIVEL_3);
+		if (p->rueda_ranura)
+			rueda_eliminar(p);
+		fijar_nivel_int(nivel);
+	}
+	for (c=0; c<MAX_CPUS; c++) {
+		if (tabla_cpus[c].actual==p && p!=p_proc_actual)
+			tabla_cpus[c].actual=NULL;
+		if (tabla_cpus[c].cedido==p)
+			tabla_cpus[c].cedido=NULL;
+	}
+	p->estado=TERMINADO;
+	p->estado_salida=estado; //A25: para el padre.
+	soltar_grupo(p->grupo);
+	if (p->clase==CLASE_TR) {
+		printk("-> PROC %d: %d PLAZOS INCUMPLIDOS\n",
+			p->id, p->tr_fallos);
+		salir_tiempo_real(p);
+	}
+	if (p->proceso!=p) /* los del proceso se sueltan al cerrar sus descriptores */
+		soltar_cerrojos(p);
+	insertar_ultimo(&lista_terminados, p); //A25: se recoge luego.
 }
 
 /*
  *
  * Funcion auxiliar que termina proceso actual liberando sus recursos.
  * Usada por llamada terminar_proceso y por rutinas que tratan excepciones
+ * A25: la pila, la imagen y el BCP se recogen después (trabajo_terminados)
+ * A27: si es un hilo sólo termina él; si es un proceso, mueren con él
+ * los hilos que le queden.
  *
  */
-static void liberar_proceso(){
+static void liberar_proceso(int estado){
 	BCP * p_proc_anterior;
-
-	liberar_imagen(p_proc_actual->info_mem); /* liberar mapa */
-
-	p_proc_actual->estado=TERMINADO;
-	for (int i = 0; i < NUM_MUT_PROC; i++)
+	int id_anterior;
+	BCP * hilo;
+
+	reloj_periodico(); /* A12: se le cargan los ticks ya consumidos */
+
+	/* A8: retorno y tiempo de CPU, para comparar políticas */
+	printk("-> PROC %d (%s): RETORNO %lu TICKS, CPU %lu TICKS (EN CPU %d)\n",
+		p_proc_actual->id, politica->nombre,
+		ticks_sistema-p_proc_actual->ticks_creacion,
+		p_proc_actual->ticks_cpu, cpu_actual);
+	/* A16: efecto de la holgura de los temporizadores */
+	printk("-> %lu CAMBIOS DE CONTEXTO, %lu TICKS CON DESPERTARES\n",
+		cambios_contexto, ticks_despertar);
+
+	//A27: primero los hilos del proceso (un hilo no tiene), que pueden tener mutex cerrados.
+	for (hilo = p_proc_actual->primer_hilo; hilo; hilo = hilo->sig_hilo)
+		if (hilo->estado != TERMINADO && hilo->estado != ZOMBI)
+			retirar_BCP(hilo, ESTADO_MATADO);
+	retirar_BCP(p_proc_actual, estado); /* proc. fuera de listos */
+	if (p_proc_actual->proceso==p_proc_actual)
 	{
-		if (p_proc_actual->descriptores_mutex[i] != -1) //Si el proceso tiene un descriptor de mutex asociado entonces
+		for (int i = 0; i < NUM_MUT_PROC; i++)
 		{
-			escribir_registro(1, (long)i); //Escribir en el registro 1 el descriptor.
-			printk("Se va a liberar el descriptor %d\n", i);
-			sis_cerrar_mutex();
+			if (p_proc_actual->descriptores_mutex[i] != -1) //Si el proceso tiene un descriptor de mutex asociado entonces
+			{
+				escribir_registro(1, (long)i); //Escribir en el registro 1 el descriptor.
+				printk("Se va a liberar el descriptor %d\n", i);
+				sis_cerrar_mutex();
+			}
 		}
 	}
-	eliminar_primero(&lista_listos); /* proc. fuera de listos */
+	diferir(DIFERIDO_TERMINADOS);
 
 	/* Realizar cambio de contexto */
+	/* A25: si no hay listos, el trabajo diferido puede recoger a este
+	   mismo proceso y dar su entrada (con otro id) mientras se espera */
 	p_proc_anterior=p_proc_actual;
+	id_anterior=p_proc_anterior->id;
 	p_proc_actual=planificador();
 	printk("-> C.CONTEXTO POR FIN: de %d a %d\n",
-			p_proc_anterior->id, p_proc_actual->id);
+			id_anterior, p_proc_actual->id);
+	if (num_pilas_salida>0) //A25: se devuelven ya sobre la pila del siguiente.
+		diferir(DIFERIDO_TERMINADOS);
 
-	liberar_pila(p_proc_anterior->pila);
-	cambio_contexto(NULL, &(p_proc_actual->contexto_regs));
+	cambios_contexto++;
+	poner_datos(p_proc_actual); //A22: sus datos en la imagen.
+	cambio_contexto(NULL, p_proc_actual->contexto_regs);
         return; /* no deber�a llegar aqui */
 }
 
+/*
+ * A27: quita un hilo de la lista de hilos de su proceso
+ */
+static void quitar_hilo(BCP * hilo){
+	if (hilo->ant_hilo)
+		hilo->ant_hilo->sig_hilo=hilo->sig_hilo;
+	else
+		hilo->proceso->primer_hilo=hilo->sig_hilo;
+	if (hilo->sig_hilo)
+		hilo->sig_hilo->ant_hilo=hilo->ant_hilo;
+}
+
+/*
+ * A27: despierta a los hilos del proceso dueno que esperan por p: por su
+ * identificador o, si p es un proceso, por cualquier hijo
+ */
+static void avisar_esperas(BCP * p, BCP * dueno){
+	BCP *proc, *sig;
+
+	for (proc=lista_esperando_hijos.primero; proc; proc=sig) {
+		sig=proc->siguiente;
+		if (proc->proceso==dueno && (proc->hijo_esperado==p->id ||
+		    (proc->hijo_esperado==ESPERA_CUALQUIERA && p->proceso==p)))
+			desbloquear_proceso(&lista_esperando_hijos, proc);
+	}
+}
+
+/*
+ * A25: devuelve una pila de un proceso que se recoge. Si es el actual,
+ * se está recogiendo en el rato ocioso de su propio liberar_proceso y
+ * todavía se ejecuta sobre ella: se guarda hasta después del cambio de
+ * contexto.
+ */
+static void devolver_pila_de(BCP * p, void *pila){
+	if (p!=p_proc_actual || num_pilas_salida>=MAX_PILAS_SALIDA) {
+		devolver_pila(pila, p->clase_pila);
+		return;
+	}
+	pilas_salida[num_pilas_salida++]=pila;
+	clase_pilas_salida=p->clase_pila;
+}
+
+/*
+ * A25: trabajo diferido que recoge los procesos terminados. Devuelve su
+ * pila y su imagen, deja sin padre a sus hijos (liberando los que ya eran
+ * zombis) y, si su padre sigue vivo, lo deja como zombi y despierta al
+ * padre si lo está esperando; si no, libera su entrada. soltar_imagen va
+ * primero porque con el último proceso el HAL termina el sistema.
+ * A27: un hilo sólo tiene su pila, que se queda el proceso para su
+ * siguiente hilo si no tiene ya una; queda como zombi si su proceso sigue
+ * vivo. Los hilos de un proceso van en la lista antes que él, así que
+ * cuando se recoge el proceso sólo le quedan hilos zombis.
+ */
+void trabajo_terminados(){
+	BCP *p, *hijo, *sig;
+
+	/* las del que terminó antes, si ya no se ejecuta sobre ellas */
+	if (p_proc_actual->estado!=TERMINADO && p_proc_actual->estado!=ZOMBI)
+		while (num_pilas_salida>0)
+			devolver_pila(pilas_salida[--num_pilas_salida], clase_pilas_salida);
+
+	while ((p=lista_terminados.primero)!=NULL) {
+		eliminar_primero(&lista_terminados);
+		if (p->proceso!=p) {
+			if (p->proceso->estado==TERMINADO) {
+				devolver_pila_de(p, p->pila);
+				quitar_hilo(p);
+				liberar_BCP(p);
+			}
+			else {
+				/* su pila sólo tiene datos del proceso: no hace falta limpiarla */
+				if (p->proceso->pila_hilo==NULL)
+					p->proceso->pila_hilo=p->pila;
+				else
+					devolver_pila_de(p, p->pila);
+				p->estado=ZOMBI;
+				avisar_esperas(p, p->proceso);
+			}
+			continue;
+		}
+		soltar_imagen(p); //A22: la imagen queda en la caché.
+		//A27: la de reserva para hilos antes que la suya, que puede
+		//estar usando todavía.
+		if (p->pila_hilo)
+			devolver_pila(p->pila_hilo, p->clase_pila);
+		while (p->num_pilas_fibras>0) //A28: puede estar ejecutando en una.
+			devolver_pila_de(p, p->pilas_fibras[--p->num_pilas_fibras]);
+		devolver_pila_de(p, p->pila); //A19: se limpia y reutiliza en ratos ociosos.
+		for (hijo=p->primer_hilo; hijo; hijo=sig) {
+			sig=hijo->sig_hilo;
+			liberar_BCP(hijo); //A27: hilos zombis
+		}
+		p->primer_hilo=NULL;
+		for (hijo=p->primer_hijo; hijo; hijo=sig) {
+			sig=hijo->sig_hermano;
+			hijo->padre=NULL;
+			if (hijo->estado==ZOMBI)
+				liberar_BCP(hijo);
+		}
+		p->primer_hijo=NULL;
+		if (p->padre==NULL) {
+			liberar_BCP(p); //A20: ya nadie usa su BCP.
+			continue;
+		}
+		p->estado=ZOMBI;
+		avisar_esperas(p, p->padre); //A27: puede esperarlo cualquier hilo del padre.
+	}
+}
+
 /*
  *
  * Funciones relacionadas con el tratamiento de interrupciones
  *	excepciones: exc_arit exc_mem
- *	interrupciones de reloj: int_reloj
+ *	interrupciones de reloj: int_reloj trabajo_reloj procesar_tick
  *	interrupciones del terminal: int_terminal
  *	llamadas al sistemas: llam_sis
  *	interrupciones SW: int_sw
@@ -198,7 +2230,7 @@ static void exc_arit(){
 
 
 	printk("-> EXCEPCION ARITMETICA EN PROC %d\n", p_proc_actual->id);
-	liberar_proceso();
+	liberar_proceso(ESTADO_EXCEPCION);
 
         return; /* no deber�a llegar aqui */
 }
@@ -213,7 +2245,7 @@ static void exc_mem(){
 
 
 	printk("-> EXCEPCION DE MEMORIA EN PROC %d\n", p_proc_actual->id);
-	liberar_proceso();
+	liberar_proceso(ESTADO_EXCEPCION);
 
         return; /* no deber�a llegar aqui */
 }
@@ -231,36 +2263,89 @@ static void int_terminal(){
 }
 
 /*
- * Tratamiento de interrupciones de reloj
+ * Trabajo de cada tick de reloj
  */
-static void int_reloj(){
+static void procesar_tick(){
+	BCP *proc, *sig;
 
-	printk("-> TRATANDO INT. DE RELOJ\n");
-	BCP *lista = lista_dormidos.primero;
+	ticks_sistema++;
 
-	while (lista != NULL)
+	//A13: sólo se miran los dormidos que vencen en este tick.
+	if ((proc = rueda_avanzar()) != NULL)
+		ticks_despertar++; //A16
+	for (; proc != NULL; proc = sig)
 	{
-		lista->segs_dormir--;
-		if (lista->segs_dormir <= 0)
-		{
-			lista->estado = LISTO;
-			lista->ticks = TICKS_POR_RODAJA;
-			eliminar_elem(&lista_dormidos, lista);
-			insertar_ultimo(&lista_listos, lista);
-		}
-		lista = lista->siguiente;
+		sig = proc->rueda_sig;
+		//A26: si esperaba sitio en la tabla, se acaba su plazo.
+		desbloquear_proceso(proc->lista_bloqueo, proc);
 	}
 	if (p_proc_actual->estado == LISTO)
 	{
-		p_proc_actual->ticks--;
-		if (p_proc_actual->ticks <= 0)
-		{
-			activar_int_SW();
-		}
+		p_proc_actual->ticks_cpu++;
+		tabla_cpus[cpu_actual].ticks_ocupada++; //A10: contabilidad por CPU.
+	}
+	else
+		tabla_cpus[cpu_actual].ticks_ociosa++;
+	if (p_proc_actual->estado == LISTO && p_proc_actual->clase == CLASE_TR)
+	{
+		if (tr_tick(p_proc_actual))
+			pedir_expulsion();
+		if (politica->tick(NULL))
+			pedir_expulsion();
+	}
+	else if (politica->tick(p_proc_actual->estado == LISTO ? p_proc_actual : NULL))
+		pedir_expulsion(); //Rodaja agotada o hay otro que debe ejecutar.
+	//A9: consumo de los grupos y recarga al final de cada ventana.
+	if (p_proc_actual->estado == LISTO && p_proc_actual->clase == CLASE_NORMAL &&
+	    cargar_tick_grupo(p_proc_actual))
+		pedir_expulsion();
+	if (--ticks_hasta_recarga <= 0)
+	{
+		ticks_hasta_recarga = VENTANA_GRUPOS;
+		recargar_grupos();
+	}
+	//A10: cada tick ejecuta la siguiente CPU virtual con trabajo.
+	if (num_cpus > 1 && siguiente_cpu() != cpu_actual)
+	{
+		rotar_cpus = 1;
+		pedir_expulsion();
 	}
+	if (procs_tr && activar_periodos_tr())
+		pedir_expulsion();
+}
+
+/*
+ * Tratamiento de interrupciones de reloj. A18: sólo anota los ticks; el
+ * resto se hace en trabajo_reloj, de modo que el tiempo a nivel 3 no
+ * depende del número de procesos.
+ */
+static void int_reloj(){
+
+	//A12: con el reloj dinámico una interrupción puede valer varios ticks.
+	ticks_pendientes += ticks_por_int;
+	clock_gettime(CLOCK_MONOTONIC, &ultimo_tick); //A14: base para interpolar.
+	diferir(DIFERIDO_RELOJ);
         return;
 }
 
+/* A18
+ * Parte diferida del tratamiento de las interrupciones de reloj. Procesa
+ * los ticks anotados desde la última vez.
+ */
+void trabajo_reloj(){
+	int n, nivel;
+
+	nivel = fijar_nivel_int(NIVEL_3);
+	n = ticks_pendientes;
+	ticks_pendientes = 0;
+	fijar_nivel_int(nivel);
+
+	printk("-> TRATANDO INT. DE RELOJ\n");
+	while (n-- > 0)
+		procesar_tick();
+	ajustar_reloj();
+}
+
 /*
  * Tratamiento de llamadas al sistema
  */
@@ -282,69 +2367,177 @@ static void tratar_llamsis(){
 static void int_sw(){
 
 	BCP *p_proc;
+
+	ejecutar_diferidos(); //A18: trabajo de los manejadores de interrupción.
+	if (!expulsion_pendiente)
+		return;
+	expulsion_pendiente = 0;
 	p_proc = p_proc_actual;
 	printk("-> TRATANDO INT. SW\n");
-	if (lista_listos.primero == lista_listos.ultimo)
+	if (p_proc->estado == LISTO && p_proc->clase == CLASE_NORMAL &&
+	    grupo_limitado(p_proc))
+		aparcar_proceso(p_proc); //A9: su grupo ha agotado lo suyo.
+	if (rotar_cpus) //A10: turno de la siguiente CPU; el actual sigue siendo el de la suya.
 	{
-		p_proc_actual->ticks = TICKS_POR_RODAJA;
+		rotar_cpus = 0;
+		if (tabla_cpus[cpu_actual].cedido == NULL) //A11: antes se atiende la cesión.
+			cpu_actual = siguiente_cpu();
 	}
-	else
+	p_proc_actual = planificador(); //La política ya ha recolocado al actual si ha agotado su rodaja.
+	if (p_proc_actual != p_proc)
 	{
-		eliminar_elem(&lista_listos, p_proc_actual);
-		insertar_ultimo(&lista_listos, p_proc_actual);
-
-		p_proc_actual = planificador();
-		p_proc_actual->ticks = TICKS_POR_RODAJA;
-		cambio_contexto(&(p_proc->contexto_regs), &(p_proc_actual->contexto_regs));
+		cambios_contexto++;
+		poner_datos(p_proc_actual); //A22: sus datos en la imagen.
+		cambio_contexto(p_proc->contexto_regs, p_proc_actual->contexto_regs);
 	}
 	return;
 }
 
+/*
+ * A27: inicia los campos de un BCP nuevo, de proceso o de hilo, que no
+ * dependen de la imagen: lo que hereda del creador, la contabilidad y
+ * los enlaces con otros BCP
+ */
+static void iniciar_BCP(BCP * p_proc){
+	p_proc->estado=LISTO; //A20: el id ya viene con su generación.
+
+	p_proc->rueda_ranura=NULL; //A13: no está en la rueda de dormidos.
+	p_proc->lista_bloqueo=NULL; //A27
+	p_proc->num_pilas_fibras=0; //A28
+	p_proc->temp_periodo=0; //A15: sin temporizador periódico.
+	p_proc->holgura = p_proc_actual ? p_proc_actual->holgura : 0; //A16: se hereda.
+	//A2: se inicializan los descriptores a -1, un número que identifica que NO hay ningun mutex asociado.
+	for(int j = 0; j < NUM_MUT_PROC; j++)
+		p_proc->descriptores_mutex[j] = -1;
+	//A4: el hijo hereda la prioridad del creador.
+	p_proc->prioridad = p_proc_actual ? p_proc_actual->prioridad : PRIORIDAD_DEF;
+	p_proc->vruntime = 0;
+	p_proc->ticks_creacion = ticks_sistema;
+	p_proc->ticks_cpu = 0;
+	p_proc->clase = CLASE_NORMAL; //A7: el tiempo real no se hereda.
+	p_proc->tr_fallos = 0;
+	//A9: el hijo entra en el grupo del creador.
+	p_proc->grupo = p_proc_actual ? p_proc_actual->grupo : 0;
+	tabla_grupos[p_proc->grupo].nrefs++;
+
+	p_proc->padre = NULL;
+	p_proc->primer_hijo = NULL;
+	p_proc->sig_hermano = p_proc->ant_hermano = NULL;
+	p_proc->hijo_esperado = NO_ESPERA;
+	p_proc->primer_hilo = NULL;
+	p_proc->sig_hilo = p_proc->ant_hilo = NULL;
+	p_proc->pila_hilo = NULL;
+}
+
+/*
+ * A27: mete un proceso o hilo recién creado en la cola de listos de la
+ * CPU menos cargada, o lo aparta si su grupo está limitado
+ */
+static void lanzar_BCP(BCP * p_proc){
+	p_proc->cpu = cpu_menos_cargada(); //A10: reparto de carga entre CPUs.
+	politica->iniciar(p_proc); //A8: campos propios de la política.
+	if (grupo_limitado(p_proc))
+	{
+		p_proc->estado = BLOQUEADO;
+		insertar_ultimo(&lista_limitados, p_proc);
+		p_proc->lista_bloqueo = &lista_limitados;
+	}
+	else
+		insertar_listo(p_proc);
+}
+
 /*
  *
  * Funcion auxiliar que crea un proceso reservando sus recursos.
  * Usada por llamada crear_proceso.
  *
+ * A24: crea n procesos del mismo programa de una vez. La imagen se busca
+ * una sola vez, se rellenan todos los BCP y después se meten juntos en la
+ * cola de listos. Deja en pids el identificador de cada uno, o -1 si no
+ * se ha podido crear, y devuelve cuántos ha creado.
+ *
  */
-static int crear_tarea(char *prog){
-	void * imagen, *pc_inicial;
-	int error=0;
-	int proc;
+static int crear_tareas(char *prog, int n, int *pids){
+	imagen_prog *imagen;
+	lista_BCPs nuevos={NULL, NULL};
+	int i;
 	BCP *p_proc;
 
-	proc=buscar_BCP_libre();
-	if (proc==-1)
-		return -1;	/* no hay entrada libre */
-
-	/* A rellenar el BCP ... */
-	p_proc=&(tabla_procs[proc]);
+	for (i=0; i<n; i++)
+		pids[i]=-1;
 
 	/* crea la imagen de memoria leyendo ejecutable */
-	imagen=crear_imagen(prog, &pc_inicial);
-	if (imagen)
-	{
-		p_proc->info_mem=imagen;
-		p_proc->pila=crear_pila(TAM_PILA);
-		fijar_contexto_ini(p_proc->info_mem, p_proc->pila, TAM_PILA,
-			pc_inicial,
-			&(p_proc->contexto_regs));
-		p_proc->id=proc;
-		p_proc->estado=LISTO;
-
-		p_proc->segs_dormir=0; //A1: se inicializa el atributo
-		/* lo inserta al final de cola de listos */
-		//A2: se inicializan los descriptores a -1, un número que identifica que NO hay ningun mutex asociado.
-		for(int i = 0; i < NUM_MUT_PROC; i++)
-			p_proc->descriptores_mutex[i] = -1;
-		p_proc->ticks = TICKS_POR_RODAJA;
-	
-		insertar_ultimo(&lista_listos, p_proc);
-		error= 0;
+	imagen=obtener_imagen(prog); //A22: sólo se lee si no está en la caché.
+	if (imagen==NULL)
+		return 0; /* fallo al crear imagen */
+
+	/* A rellenar los BCP ... */
+	for (i=0; i<n; i++)
+	{
+		p_proc=buscar_BCP_libre(); //A20: la tabla crece si hace falta.
+		if (p_proc==NULL)
+			break;	/* no hay entrada libre */
+		p_proc->datos=NULL; /* una imagen sin datos no necesita copia */
+		if (imagen->tam_datos &&
+		    (p_proc->datos=malloc(imagen->tam_datos))==NULL) {
+			liberar_BCP(p_proc); /* no hay memoria para sus datos */
+			break;
+		}
+		p_proc->clase_pila=imagen->clase_pila; //A23: la que pide el programa.
+		p_proc->pila=obtener_pila(p_proc->clase_pila); //A19: de la reserva si hay.
+		if (p_proc->pila==NULL) {
+			free(p_proc->datos); /* ni para su pila */
+			liberar_BCP(p_proc);
+			break;
+		}
+		if (i>0)
+			imagen->nrefs++; /* una referencia por proceso */
+
+		p_proc->info_mem=imagen->mem;
+		p_proc->imagen=imagen;
+		if (imagen->tam_datos)
+			memcpy(p_proc->datos, imagen->datos_ini, imagen->tam_datos);
+		procesos_vivos++;
+		fijar_contexto_ini(p_proc->info_mem, p_proc->pila,
+			TAM_CLASE_PILA(p_proc->clase_pila),
+			imagen->pc_inicial,
+			p_proc->contexto_regs);
+		iniciar_BCP(p_proc); //A27
+		p_proc->proceso = p_proc;
+
+		//A25: es hijo del creador. A27: si es un hilo, de su proceso.
+		if (p_proc_actual)
+		{
+			p_proc->padre = p_proc_actual->proceso;
+			p_proc->sig_hermano = p_proc->padre->primer_hijo;
+			if (p_proc->sig_hermano)
+				p_proc->sig_hermano->ant_hermano = p_proc;
+			p_proc->padre->primer_hijo = p_proc;
+		}
+
+		pids[i]= p_proc->id; //A11: se devuelve el identificador del nuevo proceso.
+		insertar_ultimo(&nuevos, p_proc);
 	}
-	else
-		error= -1; /* fallo al crear imagen */
+	if (i==0)
+		dejar_imagen(imagen); /* ningún proceso se ha quedado la referencia */
+
+	/* los inserta al final de cola de listos */
+	while ((p_proc=nuevos.primero)!=NULL)
+	{
+		eliminar_primero(&nuevos);
+		lanzar_BCP(p_proc); //A27
+	}
+	return i;
+}
+
+/*
+ * Crea un solo proceso. Devuelve su identificador o -1.
+ */
+static int crear_tarea(char *prog){
+	int pid;
 
-	return error;
+	crear_tareas(prog, 1, &pid);
+	return pid;
 }
 
 /*
@@ -368,6 +2561,274 @@ int sis_crear_proceso(){
 	return res;
 }
 
+/*
+ * A26: bloquea al proceso actual hasta que se libere una entrada de la
+ * tabla de procesos o, si con_limite, hasta el instante limite del reloj
+ * monótono, lo que antes ocurra. Como en dormir_hasta, el tick de
+ * despertar no puede pasar antes de bloquearse.
+ */
+static void esperar_entrada(int con_limite, unsigned long long limite){
+	int nivel;
+
+	reloj_periodico();
+	nivel = fijar_nivel_int(NIVEL_3);
+	if (con_limite)
+	{
+		p_proc_actual->despertar = (limite + US_POR_TICK - 1) / US_POR_TICK;
+		rueda_insertar(p_proc_actual);
+	}
+	bloquear_proceso(&lista_esperando_entrada);
+	fijar_nivel_int(nivel);
+}
+
+/*
+ * A26: despierta al primero de los que esperan sitio en la tabla,
+ * sacándolo de la rueda si esperaba con plazo. Si otro proceso ocupa
+ * antes la entrada, el despertado vuelve a esperar.
+ */
+static void avisar_entrada_libre(){
+	BCP *proc=lista_esperando_entrada.primero;
+	int nivel;
+
+	nivel = fijar_nivel_int(NIVEL_3);
+	if (proc->rueda_ranura)
+		rueda_eliminar(proc);
+	fijar_nivel_int(nivel);
+	desbloquear_proceso(&lista_esperando_entrada, proc);
+}
+
+/*
+ * A26: tratamiento de llamada al sistema crear_proceso_espera. Como
+ * crear_proceso, pero si la tabla de procesos está llena espera a que
+ * se libere una entrada, sin límite (ESPERA_INDEFINIDA) o como mucho ms
+ * milisegundos. Devuelve el identificador del nuevo proceso, o -1 si se
+ * acaba el plazo o no se puede crear.
+ */
+int sis_crear_proceso_espera(){
+	char *prog;
+	int ms;
+	unsigned long long limite=0;
+
+	prog=(char *)leer_registro(1);
+	ms=(int)leer_registro(2);
+	printk("-> PROC %d: CREAR PROCESO (ESPERA %d MS)\n", p_proc_actual->id, ms);
+	if (ms != ESPERA_INDEFINIDA)
+	{
+		if (ms < 0)
+			return -1;
+		limite = tiempo_monotono() + (unsigned long long)ms * 1000;
+	}
+	while (lista_libres.primero==NULL && tam_tabla_procs>=MAX_PROC)
+	{
+		if (ms != ESPERA_INDEFINIDA && tiempo_monotono() >= limite)
+			return -1;
+		esperar_entrada(ms != ESPERA_INDEFINIDA, limite);
+	}
+	return crear_tarea(prog);
+}
+
+/*
+ * A25: devuelve el hijo del proceso actual con ese identificador, esté
+ * vivo, terminado o zombi, o NULL si no es hijo suyo. No vale
+ * buscar_proceso porque un terminado aún sin recoger está como NO_USADA.
+ */
+static BCP * buscar_hijo(int pid){
+	BCP *p;
+
+	if (pid<0 || INDICE_PID(pid)>=tam_tabla_procs)
+		return NULL;
+	p=BCP_TABLA(INDICE_PID(pid));
+	if (p->id!=pid || p->padre!=p_proc_actual->proceso)
+		return NULL;
+	return p;
+}
+
+/*
+ * A25: tratamiento de llamada al sistema esperar_proceso. Espera a que
+ * termine el hijo pid, o cualquiera con ESPERA_CUALQUIERA, deja su estado
+ * de terminación en estado (si no es NULL) y libera su entrada. Devuelve
+ * el identificador del hijo, o -1 si no hay ese hijo o ninguno.
+ */
+int sis_esperar_proceso(){
+	int pid, *estado;
+	BCP *hijo, *proc=p_proc_actual->proceso; //A27: los hijos son del proceso.
+
+	pid=(int)leer_registro(1);
+	estado=(int *)leer_registro(2);
+
+	for (;;) {
+		if (pid==ESPERA_CUALQUIERA) {
+			if (proc->primer_hijo==NULL)
+				return -1;
+			for (hijo=proc->primer_hijo; hijo; hijo=hijo->sig_hermano)
+				if (hijo->estado==ZOMBI)
+					break;
+		}
+		else if ((hijo=buscar_hijo(pid))==NULL)
+			return -1;
+		if (hijo && hijo->estado==ZOMBI)
+			break;
+		p_proc_actual->hijo_esperado=pid;
+		bloquear_proceso(&lista_esperando_hijos);
+		p_proc_actual->hijo_esperado=NO_ESPERA;
+	}
+
+	if (estado)
+		*estado=hijo->estado_salida;
+	pid=hijo->id;
+	if (hijo->ant_hermano)
+		hijo->ant_hermano->sig_hermano=hijo->sig_hermano;
+	else
+		proc->primer_hijo=hijo->sig_hermano;
+	if (hijo->sig_hermano)
+		hijo->sig_hermano->ant_hermano=hijo->ant_hermano;
+	liberar_BCP(hijo);
+	return pid;
+}
+
+/*
+ * A24: tratamiento de llamada al sistema crear_procesos. Crea n procesos
+ * del programa en una sola llamada y deja sus identificadores en pids.
+ * Devuelve cuántos ha creado, o -1 si los parámetros no son válidos.
+ */
+int sis_crear_procesos(){
+	char *prog;
+	int n, *pids;
+
+	prog=(char *)leer_registro(1);
+	n=(int)leer_registro(2);
+	pids=(int *)leer_registro(3);
+	printk("-> PROC %d: CREAR %d PROCESOS\n", p_proc_actual->id, n);
+	if (n<=0 || pids==NULL)
+		return -1;
+	return crear_tareas(prog, n, pids);
+}
+
+/*
+ * A27: tratamiento de llamada al sistema crear_hilo. Crea un hilo del
+ * proceso actual que empieza en la función inicio de la biblioteca, la
+ * cual pide con arrancar_hilo la función y el argumento del usuario. No
+ * hay que buscar ni cargar imagen ni copiar datos: sólo hace falta un
+ * BCP y una pila. Devuelve el identificador del hilo o -1.
+ */
+int sis_crear_hilo(){
+	void *inicio, *funcion, *arg;
+	BCP *proc=p_proc_actual->proceso, *hilo;
+
+	inicio=(void *)leer_registro(1);
+	funcion=(void *)leer_registro(2);
+	arg=(void *)leer_registro(3);
+	printk("-> PROC %d: CREAR HILO\n", p_proc_actual->id);
+	if (inicio==NULL || funcion==NULL || (hilo=buscar_BCP_libre())==NULL)
+		return -1;
+
+	hilo->info_mem=proc->info_mem;
+	hilo->imagen=proc->imagen;
+	hilo->datos=proc->datos;
+	hilo->clase_pila=proc->clase_pila;
+	if ((hilo->pila=proc->pila_hilo)!=NULL)
+		proc->pila_hilo=NULL; /* la de un hilo anterior del proceso */
+	else if ((hilo->pila=obtener_pila(hilo->clase_pila))==NULL) {
+		liberar_BCP(hilo);
+		return -1;
+	}
+	fijar_contexto_ini(hilo->info_mem, hilo->pila,
+		TAM_CLASE_PILA(hilo->clase_pila), inicio, hilo->contexto_regs);
+	iniciar_BCP(hilo);
+	hilo->proceso=proc;
+	hilo->hilo_funcion=funcion;
+	hilo->hilo_arg=arg;
+	hilo->sig_hilo=proc->primer_hilo;
+	if (hilo->sig_hilo)
+		hilo->sig_hilo->ant_hilo=hilo;
+	proc->primer_hilo=hilo;
+
+	lanzar_BCP(hilo);
+	return hilo->id;
+}
+
+/*
+ * A27: devuelve el hilo del proceso actual con ese identificador, vivo o
+ * zombi, o NULL si no es un hilo de este proceso
+ */
+static BCP * buscar_hilo(int id){
+	BCP *p;
+
+	if (id<0 || INDICE_PID(id)>=tam_tabla_procs)
+		return NULL;
+	p=BCP_TABLA(INDICE_PID(id));
+	if (p->id!=id || p->proceso!=p_proc_actual->proceso || p->proceso==p)
+		return NULL;
+	return p;
+}
+
+/*
+ * A27: tratamiento de llamada al sistema esperar_hilo. Espera a que
+ * termine otro hilo del mismo proceso, deja su estado en estado (si no
+ * es NULL) y libera su entrada. Devuelve su identificador o -1.
+ */
+int sis_esperar_hilo(){
+	int id, *estado;
+	BCP *hilo;
+
+	id=(int)leer_registro(1);
+	estado=(int *)leer_registro(2);
+
+	for (;;) {
+		if ((hilo=buscar_hilo(id))==NULL || hilo==p_proc_actual)
+			return -1;
+		if (hilo->estado==ZOMBI)
+			break;
+		p_proc_actual->hijo_esperado=id;
+		bloquear_proceso(&lista_esperando_hijos);
+		p_proc_actual->hijo_esperado=NO_ESPERA;
+	}
+
+	if (estado)
+		*estado=hilo->estado_salida;
+	quitar_hilo(hilo);
+	liberar_BCP(hilo);
+	return id;
+}
+
+/*
+ * A27: tratamiento de llamada al sistema arrancar_hilo. Deja en funcion
+ * y arg lo que tiene que ejecutar el hilo actual.
+ */
+int sis_arrancar_hilo(){
+	void **funcion, **arg;
+
+	funcion=(void **)leer_registro(1);
+	arg=(void **)leer_registro(2);
+	if (p_proc_actual->proceso==p_proc_actual)
+		return -1;
+	*funcion=p_proc_actual->hilo_funcion;
+	*arg=p_proc_actual->hilo_arg;
+	return 0;
+}
+
+/*
+ * A28: tratamiento de llamada al sistema pedir_pila. Da al proceso una
+ * pila del tamaño de la suya (con su página de guarda) para una fibra de
+ * la biblioteca. No puede estar en los datos del programa, que se copian
+ * al cambiar entre procesos de la misma imagen. Se devuelven todas cuando
+ * termina el proceso.
+ */
+int sis_pedir_pila(){
+	void **pila;
+	int *tam;
+	BCP *proc=p_proc_actual->proceso;
+
+	pila=(void **)leer_registro(1);
+	tam=(int *)leer_registro(2);
+	if (proc->num_pilas_fibras>=MAX_PILAS_FIBRAS ||
+	    (*pila=obtener_pila(proc->clase_pila))==NULL)
+		return -1;
+	proc->pilas_fibras[proc->num_pilas_fibras++]=*pila;
+	*tam=TAM_CLASE_PILA(proc->clase_pila);
+	return 0;
+}
+
 /*
  * Tratamiento de llamada al sistema escribir. Llama simplemente a la
  * funcion de apoyo escribir_ker
@@ -389,10 +2850,12 @@ int sis_escribir()
  * funcion auxiliar liberar_proceso
  */
 int sis_terminar_proceso(){
+	int estado;
 
+	estado=(int)leer_registro(1); //A25: estado de terminación.
 	printk("-> FIN PROCESO %d\n", p_proc_actual->id);
 
-	liberar_proceso();
+	liberar_proceso(estado);
 
         return 0; /* no deber�a llegar aqui */
 }
@@ -405,26 +2868,148 @@ int sis_obtener_id(){
 	return p_proc_actual->id;
 }
 
+/* A15
+ * Duerme al proceso actual hasta el instante indicado del reloj
+ * monótono. Se despierta en el primer tick que empieza en ese instante
+ * o después, de modo que el error es siempre menor que un tick y nunca
+ * por defecto, y no depende de cuándo se haga la llamada. A16: si el
+ * proceso admite holgura, puede despertar hasta holgura microsegundos
+ * más tarde en un tick compartido con otros.
+ */
+static int dormir_hasta(unsigned long long instante){
+	int nivel;
+
+	reloj_periodico(); //A12: ticks_sistema al día si el reloj estaba parado.
+	/* el tick de despertar no puede pasar antes de bloquearse */
+	nivel = fijar_nivel_int(NIVEL_3);
+	if (instante > tiempo_monotono())
+	{
+		p_proc_actual->despertar = rueda_agrupar(
+			(instante + US_POR_TICK - 1) / US_POR_TICK,
+			(instante + p_proc_actual->holgura) / US_POR_TICK);
+		rueda_insertar(p_proc_actual); //A13: se guarda en la rueda de dormidos.
+		bloquear_proceso(NULL); //Procesador multiprogramado, se pasa al siguiente proceso.
+	}
+	fijar_nivel_int(nivel);
+	return (0);
+}
+
+/* A14
+ * Duerme al proceso actual al menos us microsegundos.
+ */
+static int dormir_us(unsigned long us){
+	if (us == 0)
+		return (0);
+	return dormir_hasta(tiempo_monotono() + us); //A15
+}
+
 /* A1
  * Tratamiento de la llamada al sistema dormir.
  * Hace que el SO sea multiprogramado.
  */
 int sis_dormir(){
-	BCP				*p_proc_anterior;
 	unsigned int	segundos;
 
 	segundos = leer_registro(1); //Leer del registro la información sobre los segundos que debe dormir el proceso
-	p_proc_actual->segs_dormir = segundos * TICK;
-	p_proc_actual->estado = BLOQUEADO;
-	p_proc_anterior = p_proc_actual;
-	eliminar_elem(&lista_listos, p_proc_actual);
-	insertar_ultimo(&lista_dormidos, p_proc_actual);
-
-	p_proc_actual = planificador(); //Procesador multiprogramado, se pasa al siguiente proceso. Es necesario cambiar el contexto.
-	if (p_proc_actual != p_proc_anterior) //Pueden ser el mismo proceso en caso de que no haya mas procesos y se acabe de despertar, si esto pasa no hay que cambiar el contexto.
-		cambio_contexto(&(p_proc_anterior->contexto_regs), &(p_proc_actual->contexto_regs));
+	return dormir_us((unsigned long)segundos * 1000000); //A14: todas las esperas pasan por dormir_us.
+}
+
+/* A14
+ * Tratamiento de las llamadas al sistema dormir_ms y dormir_us.
+ */
+int sis_dormir_ms(){
+	unsigned int ms = (unsigned int)leer_registro(1);
+
+	return dormir_us((unsigned long)ms * 1000);
+}
+
+int sis_dormir_us(){
+	unsigned int us = (unsigned int)leer_registro(1);
+
+	return dormir_us(us);
+}
+
+/* A14
+ * Tratamiento de la llamada al sistema obtener_tiempo. Guarda en la
+ * variable indicada los microsegundos transcurridos desde el arranque
+ * según el reloj pedido: el monótono (ticks más la parte del tick en
+ * curso) o el CMOS, con resolución de milisegundos. La diferencia entre
+ * ambos es la deriva del reloj del sistema.
+ */
+int sis_obtener_tiempo(){
+	int reloj = (int)leer_registro(1);
+	unsigned long long *tiempo = (unsigned long long *)leer_registro(2);
+
+	switch (reloj) {
+	case RELOJ_MONOTONO:
+		*tiempo = tiempo_monotono(); //A15
+		return (0);
+	case RELOJ_CMOS:
+		*tiempo = (leer_reloj_CMOS() - cmos_arranque) * 1000 + us_saltados; //A17
+		return (0);
+	}
+	return (-1);
+}
+
+/* A15
+ * Tratamiento de la llamada al sistema dormir_hasta. Duerme hasta un
+ * instante absoluto del reloj monótono (microsegundos desde el arranque),
+ * de modo que un bucle periódico que suma su periodo al instante
+ * anterior no acumula el tiempo de trabajo de cada vuelta.
+ */
+int sis_dormir_hasta(){
+	unsigned long long instante = (unsigned long long)leer_registro(1);
+
+	return dormir_hasta(instante);
+}
+
+/* A15
+ * Tratamiento de la llamada al sistema fijar_temporizador. Arma el
+ * temporizador periódico del proceso actual con el periodo indicado en
+ * microsegundos, venciendo por primera vez un periodo después de ahora.
+ * Con periodo 0 lo desarma.
+ */
+int sis_fijar_temporizador(){
+	unsigned int periodo = (unsigned int)leer_registro(1);
+
+	p_proc_actual->temp_periodo = periodo;
+	p_proc_actual->temp_siguiente = tiempo_monotono() + periodo;
 	return (0);
 }
+
+/* A15
+ * Tratamiento de la llamada al sistema esperar_temporizador. Duerme hasta
+ * el siguiente vencimiento del temporizador del proceso y devuelve cuántos
+ * han pasado desde la anterior espera: 1 si el proceso va al día y más si
+ * se ha perdido algún periodo, que no se recupera. Los vencimientos son
+ * múltiplos exactos del periodo, así que no hay deriva acumulada.
+ */
+int sis_esperar_temporizador(){
+	unsigned long long ahora;
+	unsigned long long vencidos;
+
+	if (p_proc_actual->temp_periodo == 0) //No tiene temporizador.
+		return (-1);
+	dormir_hasta(p_proc_actual->temp_siguiente);
+	ahora = tiempo_monotono();
+	vencidos = (ahora - p_proc_actual->temp_siguiente) / p_proc_actual->temp_periodo + 1;
+	p_proc_actual->temp_siguiente += vencidos * p_proc_actual->temp_periodo;
+	return (vencidos);
+}
+
+/* A16
+ * Tratamiento de la llamada al sistema fijar_holgura. Fija cuántos
+ * microsegundos puede retrasarse el despertar del proceso actual para
+ * agruparlo con otros en el mismo tick, y devuelve la holgura anterior.
+ * Sus hijos posteriores la heredan.
+ */
+int sis_fijar_holgura(){
+	unsigned int holgura = (unsigned int)leer_registro(1);
+	int anterior = p_proc_actual->holgura;
+
+	p_proc_actual->holgura = holgura;
+	return (anterior);
+}
 /* A2
  * Tratamiento para crear un mutex.
  *
@@ -435,7 +3020,6 @@ int sis_crear_mutex()
 	char *nombre=(char *)leer_registro(1);
 	int	tipo = (int)leer_registro(2);
 	int descriptor;
-	BCP *p_proc_anterior;
 
 	descriptor = -1;
 
@@ -454,7 +3038,7 @@ int sis_crear_mutex()
 	}
 	for (int i = 0; i < NUM_MUT_PROC && descriptor == -1; i++) //Se realiza la busqueda de descriptor libre
 	{
-		if (p_proc_actual->descriptores_mutex[i] == -1)
+		if (p_proc_actual->proceso->descriptores_mutex[i] == -1)
 			descriptor = i;
 	}
 	if (descriptor == -1) //Si no se encuentra descriptor libre
@@ -466,12 +3050,7 @@ int sis_crear_mutex()
 	if (id == -1)
 	{
 		printk("Se está bloqueando el proceso a causa de: número maximo de mutex.\n");
-		p_proc_anterior = p_proc_actual;
-		p_proc_actual->estado = BLOQUEADO;
-		eliminar_elem(&lista_listos, p_proc_actual);
-		insertar_ultimo(&lista_bloqueados, p_proc_actual);
-		p_proc_actual = planificador();
-		cambio_contexto(&(p_proc_anterior->contexto_regs), &(p_proc_actual->contexto_regs));
+		bloquear_proceso(&lista_bloqueados);
 	}
 	id = buscar_mutex_libre();
 	if (id != -1)
@@ -485,7 +3064,7 @@ int sis_crear_mutex()
 		tabla_mutex[id].proceso_bloqueador = NULL;
 		tabla_mutex[id].procesos_bloqueados.primero = NULL;
 		tabla_mutex[id].procesos_bloqueados.ultimo = NULL;
-		p_proc_actual->descriptores_mutex[descriptor] = id;
+		p_proc_actual->proceso->descriptores_mutex[descriptor] = id;
 	}
 	return (descriptor); //Se devuelve el descriptor.
 }
@@ -508,13 +3087,13 @@ int sis_abrir_mutex()
 		return (-1);
 	for (int i = 0; i < NUM_MUT_PROC && descriptor == -1; i++)
 	{
-		if (p_proc_actual->descriptores_mutex[i] == -1)
+		if (p_proc_actual->proceso->descriptores_mutex[i] == -1)
 			descriptor = i;
 	}
 	if (descriptor == -1) //No hay descriptor libre
 		return (-1);
 	
-	p_proc_actual->descriptores_mutex[descriptor] = id;
+	p_proc_actual->proceso->descriptores_mutex[descriptor] = id;
 	return (descriptor);
 }
 int sis_lock()
@@ -523,20 +3102,19 @@ int sis_lock()
 	int mutexId;
 	Mutex *mutex;
 	
-	if (descriptor >= 4 || p_proc_actual->descriptores_mutex[descriptor] == -1) //Descriptor incorrecto.
+	if (descriptor >= 4 || p_proc_actual->proceso->descriptores_mutex[descriptor] == -1) //Descriptor incorrecto.
 		return (-1);
-	mutexId = p_proc_actual->descriptores_mutex[descriptor];
+	mutexId = p_proc_actual->proceso->descriptores_mutex[descriptor];
 	mutex = &tabla_mutex[mutexId];
 
 	printk("Pruebo a bloquear\n");
-	if (mutex->estado == MUT_BLOQUEADO && mutex->proceso_bloqueador != p_proc_actual) //Si está bloqueado y el proceso bloqueador no es el actual: bloquear el proceso actual.
+	//A27: mientras lo tenga otro, o se le haya pasado a otro al desbloquearlo, espera.
+	while (mutex->proceso_bloqueador != NULL && mutex->proceso_bloqueador != p_proc_actual) //Si está bloqueado y el proceso bloqueador no es el actual: bloquear el proceso actual.
 	{
+		//A11: el propietario aprovecha lo que queda de rodaja para salir antes de la sección crítica.
+		ceder_turno(mutex->proceso_bloqueador);
 		//Se bloquea el proceso.
-		BCP *aux = p_proc_actual;
-		eliminar_elem(&lista_listos, p_proc_actual);
-		insertar_ultimo(&mutex->procesos_bloqueados, p_proc_actual);
-		p_proc_actual = planificador();
-		cambio_contexto(&(aux->contexto_regs), &(p_proc_actual->contexto_regs));
+		bloquear_proceso(&mutex->procesos_bloqueados);
 	}
 	if (mutex->estado == MUT_DESBLOQUEADO && (mutex->proceso_bloqueador == NULL || mutex->proceso_bloqueador == p_proc_actual))
 	{
@@ -554,15 +3132,31 @@ int sis_lock()
 	}
 	return (0);
 }
+/*
+ * A28: tratamiento de llamada al sistema intentar_lock. Como lock, pero
+ * si el mutex lo tiene otro devuelve 1 en vez de bloquearse.
+ */
+int sis_intentar_lock()
+{
+	unsigned int descriptor = (unsigned int) leer_registro(1);
+	Mutex *mutex;
+
+	if (descriptor >= 4 || p_proc_actual->proceso->descriptores_mutex[descriptor] == -1) //Descriptor incorrecto.
+		return (-1);
+	mutex = &tabla_mutex[p_proc_actual->proceso->descriptores_mutex[descriptor]];
+	if (mutex->proceso_bloqueador != NULL && mutex->proceso_bloqueador != p_proc_actual)
+		return (1);
+	return sis_lock();
+}
 int sis_unlock()
 {
 	unsigned int descriptor = (unsigned int) leer_registro(1);
 	int mutexId;
 	Mutex *mutex;
 	
-	if (descriptor >= 4 || p_proc_actual->descriptores_mutex[descriptor] == -1) //Descriptor incorrecto.
+	if (descriptor >= 4 || p_proc_actual->proceso->descriptores_mutex[descriptor] == -1) //Descriptor incorrecto.
 		return (-1);
-	mutexId = p_proc_actual->descriptores_mutex[descriptor];
+	mutexId = p_proc_actual->proceso->descriptores_mutex[descriptor];
 	mutex = &tabla_mutex[mutexId];
 
 	if (mutex->estado == MUT_BLOQUEADO && mutex->proceso_bloqueador != p_proc_actual)
@@ -574,13 +3168,15 @@ int sis_unlock()
 		mutex->veces_bloq--;
 		printk("Veces bloqueado -1 ahora su valor es: %d\n", mutex->veces_bloq);
 		if (mutex->veces_bloq == 0)
+		{
 			mutex->estado = MUT_DESBLOQUEADO;
+			mutex->proceso_bloqueador = NULL; //A27: si no lo espera nadie, queda libre.
+		}
 		if (mutex->estado == MUT_DESBLOQUEADO && mutex->procesos_bloqueados.primero != NULL)
 		{
 			printk("Desbloqueando...\n");
 			BCP *aux = mutex->procesos_bloqueados.primero;
-			eliminar_elem(&mutex->procesos_bloqueados, aux);
-			insertar_ultimo(&lista_listos, aux);
+			desbloquear_proceso(&mutex->procesos_bloqueados, aux);
 			mutex->proceso_bloqueador = aux;
 		}
 	}
@@ -594,27 +3190,27 @@ int sis_cerrar_mutex()
 	int	liberar;
 	BCP *bloqueado_restaurar;
 	
-	if (descriptor >= 4 || p_proc_actual->descriptores_mutex[descriptor] == -1) //Descriptor incorrecto.
+	if (descriptor >= 4 || p_proc_actual->proceso->descriptores_mutex[descriptor] == -1) //Descriptor incorrecto.
 		return (-1);
-	mutexId = p_proc_actual->descriptores_mutex[descriptor];
+	mutexId = p_proc_actual->proceso->descriptores_mutex[descriptor];
 	mutex = &tabla_mutex[mutexId];
 
 	while (mutex->estado != MUT_DESBLOQUEADO && mutex->proceso_bloqueador == p_proc_actual) //SI el proceso que cierra el mutex lo tiene bloqueado, desbloquearlo las veces necesarias.
 	{
 		sis_unlock();
 	}
-	p_proc_actual->descriptores_mutex[descriptor] = -1;
+	p_proc_actual->proceso->descriptores_mutex[descriptor] = -1;
 	printk("Un mutex ha sido cerrado\n");
 	liberar = 1;
-	for (int i = 0; i < MAX_PROC && liberar == 1; i++) 
+	for (int i = 0; i < tam_tabla_procs && liberar == 1; i++) 
 	{
-    	if (tabla_procs[i].estado != NO_USADA)
+    	if (BCP_TABLA(i)->estado != NO_USADA)
 		{
         	for (int j = 0; j < NUM_MUT_PROC && liberar == 1; j++)
 			{
-            	if (tabla_procs[i].descriptores_mutex[j] == mutexId)
+            	if (BCP_TABLA(i)->descriptores_mutex[j] == mutexId)
 				{
-                	printk("No puede ser liberado por el proceso %d\n", i);
+                	printk("No puede ser liberado por el proceso %d\n", BCP_TABLA(i)->id);
             	 	liberar = 0; 
             	}
         	}
@@ -627,23 +3223,205 @@ int sis_cerrar_mutex()
 		if (lista_bloqueados.primero != NULL)
 		{
 			bloqueado_restaurar = lista_bloqueados.primero;
+			desbloquear_proceso(&lista_bloqueados, bloqueado_restaurar);
+		}
+	}
+	return (0);
+}
+/* A4
+ * Tratamiento de la llamada al sistema fijar_prioridad. Cambia el nivel
+ * de prioridad del proceso actual y devuelve el que tenía antes.
+ */
+int sis_fijar_prioridad()
+{
+	int prioridad = (int)leer_registro(1);
+	int anterior;
+
+	if (prioridad < 0 || prioridad >= NUM_PRIORIDADES) //Nivel fuera de rango.
+		return (-1);
+	anterior = p_proc_actual->prioridad;
+	eliminar_listo(p_proc_actual);
+	p_proc_actual->prioridad = prioridad;
+	politica->iniciar(p_proc_actual);
+	insertar_listo(p_proc_actual);
+	if (primer_listo() != p_proc_actual) //Hay otro proceso que debe ejecutar antes.
+		pedir_expulsion();
+	return (anterior);
+}
+/* A7
+ * Tratamiento de la llamada al sistema fijar_tiempo_real. Recibe periodo,
+ * presupuesto y plazo en milisegundos y pasa el proceso actual a la
+ * clase de tiempo real si la utilización total lo permite. Con periodo 0
+ * vuelve a la clase normal.
+ */
+static unsigned int ms_a_ticks(unsigned int ms){
+	return (ms*TICK+999)/1000;
+}
 
-			eliminar_elem(&lista_bloqueados, bloqueado_restaurar);
-			insertar_ultimo(&lista_listos, bloqueado_restaurar);
+int sis_fijar_tiempo_real()
+{
+	unsigned int periodo = ms_a_ticks((unsigned int)leer_registro(1));
+	unsigned int presupuesto = ms_a_ticks((unsigned int)leer_registro(2));
+	unsigned int plazo = ms_a_ticks((unsigned int)leer_registro(3));
+	int util, anterior;
 
-			bloqueado_restaurar->estado = LISTO;
+	if (periodo == 0) //Vuelta a la clase normal.
+	{
+		if (p_proc_actual->clase == CLASE_TR)
+		{
+			eliminar_listo(p_proc_actual);
+			salir_tiempo_real(p_proc_actual);
+			insertar_listo(p_proc_actual);
 		}
+		return (0);
+	}
+	if (presupuesto == 0 || presupuesto > plazo || plazo > periodo) //Parámetros incoherentes.
+		return (-1);
+	util = (presupuesto * 1000 + plazo - 1) / plazo;
+	anterior = (p_proc_actual->clase == CLASE_TR) ? p_proc_actual->tr_util : 0;
+	if (utilizacion_tr - anterior + util > UTIL_MAX_TR) //Control de admisión.
+	{
+		printk("-> PROC %d: TIEMPO REAL RECHAZADO (%d + %d por mil)\n",
+			p_proc_actual->id, utilizacion_tr - anterior, util);
+		return (-1);
+	}
+	eliminar_listo(p_proc_actual);
+	if (p_proc_actual->clase != CLASE_TR)
+	{
+		p_proc_actual->cpu = 0; //A10: el tiempo real sólo ejecuta en la CPU 0.
+		p_proc_actual->clase = CLASE_TR;
+		p_proc_actual->sig_tr = procs_tr;
+		procs_tr = p_proc_actual;
+	}
+	utilizacion_tr += util - anterior;
+	p_proc_actual->tr_util = util;
+	p_proc_actual->tr_periodo = periodo;
+	p_proc_actual->tr_presupuesto = presupuesto;
+	p_proc_actual->tr_plazo = plazo;
+	/* la primera activación empieza ahora */
+	p_proc_actual->tr_restante = presupuesto;
+	p_proc_actual->tr_plazo_abs = ticks_sistema + plazo;
+	p_proc_actual->tr_sig_activacion = ticks_sistema + periodo;
+	p_proc_actual->tr_pendiente = 1;
+	reloj_periodico(); //A12: hay nuevos eventos temporales.
+	insertar_listo(p_proc_actual);
+	if (primer_listo() != p_proc_actual)
+		pedir_expulsion();
+	return (0);
+}
+/* A9
+ * Tratamiento de la llamada al sistema crear_grupo. Crea un subgrupo del
+ * grupo del proceso actual con el reparto (porcentaje de la CPU del
+ * padre) y la cuota (ticks por ventana, 0 sin cuota) indicados, y mete
+ * en él al proceso actual. Sus hijos posteriores lo heredan. Devuelve el
+ * identificador del grupo.
+ */
+int sis_crear_grupo()
+{
+	int reparto = (int)leer_registro(1);
+	int cuota = (int)leer_registro(2);
+	int g, padre = p_proc_actual->grupo;
+	Grupo *gr;
+
+	if (reparto <= 0 || reparto > 100 || cuota < 0) //Parámetros fuera de rango.
+		return (-1);
+	if ((g = buscar_grupo_libre()) == -1) //No quedan grupos.
+		return (-1);
+	gr = &tabla_grupos[g];
+	gr->estado = GRUPO_USADO;
+	gr->padre = padre;
+	gr->reparto = reparto;
+	gr->limite = tabla_grupos[padre].limite * reparto / 100;
+	if (gr->limite == 0)
+		gr->limite = 1;
+	gr->cuota = cuota;
+	gr->usados = 0;
+	gr->nlistos = 0;
+	gr->nrefs = 1; //El propio proceso.
+	gr->limitado = 0;
+	tabla_grupos[padre].nrefs++;
+
+	reloj_periodico(); //A12: la cuota es un nuevo evento temporal.
+	eliminar_listo(p_proc_actual); //Así se recuentan los listos de los grupos.
+	soltar_grupo(padre);
+	p_proc_actual->grupo = g;
+	insertar_listo(p_proc_actual);
+	printk("-> PROC %d: CREA GRUPO %d (REPARTO %d%%, CUOTA %d)\n",
+		p_proc_actual->id, g, reparto, cuota);
+	return (g);
+}
+/* A11
+ * Tratamiento de la llamada al sistema ceder. El proceso actual pasa
+ * detrás de los listos de su nivel y se replanifica. En tiempo real no
+ * tiene efecto, ya que el orden lo fijan los plazos.
+ */
+int sis_ceder()
+{
+	if (p_proc_actual->clase == CLASE_NORMAL)
+	{
+		politica->ceder(p_proc_actual);
+		pedir_expulsion();
 	}
 	return (0);
 }
+/* A11
+ * Tratamiento de la llamada al sistema ceder_a. Cede lo que le queda de
+ * rodaja al proceso indicado, que ejecuta a continuación, y el actual
+ * pasa detrás de los listos de su nivel.
+ */
+int sis_ceder_a()
+{
+	int pid = (int)leer_registro(1);
+	BCP *destino;
+
+	if ((destino = buscar_proceso(pid)) == NULL) //No existe. A20: o ya ha terminado.
+		return (-1);
+	if (destino == p_proc_actual)
+		return (0);
+	if (ceder_turno(destino) < 0) //No está listo o no es de la clase normal.
+		return (-1);
+	politica->ceder(p_proc_actual);
+	pedir_expulsion();
+	return (0);
+}
 /*
  *
  * Rutina de inicializacion invocada en arranque
  *
  */
 int main(){
+	char *nombre, *cpus;
+
 	/* se llega con las interrupciones prohibidas */
 
+	/* A8: política de planificación elegida en el arranque */
+	if ((nombre=getenv("PLANIFICADOR"))==NULL)
+		nombre=POLITICA_DEF;
+	if ((politica=buscar_politica(nombre))==NULL) {
+		printk("-> POLITICA %s DESCONOCIDA: SE USA %s\n",
+			nombre, POLITICA_DEF);
+		politica=buscar_politica(POLITICA_DEF);
+	}
+	printk("-> POLITICA DE PLANIFICACION: %s\n", politica->nombre);
+
+	/* A10: número de CPUs virtuales */
+	if ((cpus=getenv("CPUS"))!=NULL)
+		num_cpus=atoi(cpus);
+	if (num_cpus<1 || num_cpus>MAX_CPUS)
+		num_cpus=1;
+	iniciar_cpus();
+	printk("-> CPUS VIRTUALES: %d\n", num_cpus);
+
+	/* A12: reloj dinámico */
+	if ((nombre=getenv("RELOJ"))!=NULL && strcmp(nombre, "dinamico")==0)
+		reloj_dinamico=1;
+	printk("-> RELOJ: %s\n", reloj_dinamico ? "dinamico" : "periodico");
+
+	/* A17: tiempo virtual */
+	if ((nombre=getenv("TIEMPO"))!=NULL && strcmp(nombre, "virtual")==0)
+		tiempo_virtual=1;
+	printk("-> TIEMPO: %s\n", tiempo_virtual ? "virtual" : "real");
+
 	instal_man_int(EXC_ARITM, exc_arit); 
 	instal_man_int(EXC_MEM, exc_mem); 
 	instal_man_int(INT_RELOJ, int_reloj); 
@@ -652,20 +3430,26 @@ int main(){
 	instal_man_int(INT_SW, int_sw); 
 
 	iniciar_cont_int();		/* inicia cont. interr. */
-	iniciar_cont_reloj(TICK);	/* fija frecuencia del reloj */
+	iniciar_pilas();		/* A23: reserva y guardas de pilas */
+	cmos_arranque=leer_reloj_CMOS();	/* A14: origen del reloj CMOS */
+	programar_reloj(1);		/* fija frecuencia del reloj */
 	iniciar_cont_teclado();		/* inici cont. teclado */
 	
 	iniciar_tabla_mutex(); /* Añadido: inicia Mutex de tabla de mutex*/
 
 	iniciar_tabla_proc();		/* inicia BCPs de tabla de procesos */
 
+	iniciar_tabla_grupos();		/* A9: inicia el grupo raíz */
+
 	/* crea proceso inicial */
 	if (crear_tarea((void *)"init")<0)
 		panico("no encontrado el proceso inicial");
 	
 	/* activa proceso inicial */
 	p_proc_actual=planificador();
-	cambio_contexto(NULL, &(p_proc_actual->contexto_regs));
+	cambios_contexto++;
+	poner_datos(p_proc_actual); //A22: sus datos en la imagen.
+	cambio_contexto(NULL, p_proc_actual->contexto_regs);
 	panico("S.O. reactivado inesperadamente");
 	return 0;
 }
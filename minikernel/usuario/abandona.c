@@ -0,0 +1,55 @@
+/*
+ * usuario/abandona.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que termina dejando hilos en todas las situaciones:
+ * uno dormido, uno bloqueado en un mutex que tiene cerrado otro hilo, ese
+ * otro esperando a un hilo que no acaba y uno que no deja de ejecutar.
+ * Deben morir todos con el proceso.
+ */
+
+#include "servicios.h"
+
+int mutex, en_bucle;
+
+static int dormido(void *arg){
+	dormir(100);
+	printf("abandona: el hilo dormido sigue. NO DEBE APARECER\n");
+	return 0;
+}
+
+static int bloqueado(void *arg){
+	lock(mutex);
+	printf("abandona: el hilo bloqueado sigue. NO DEBE APARECER\n");
+	return 0;
+}
+
+static int ocupado(void *arg){
+	for (;;)
+		en_bucle++;
+	return 0;
+}
+
+static int dueno(void *arg){
+	lock(mutex);
+	crear_hilo(bloqueado, 0);
+	esperar_hilo(crear_hilo(ocupado, 0), 0);
+	printf("abandona: el hilo que espera sigue. NO DEBE APARECER\n");
+	return 0;
+}
+
+int main(){
+	mutex=crear_mutex("abandona", NO_RECURSIVO);
+	crear_hilo(dormido, 0);
+	crear_hilo(dueno, 0);
+	while (en_bucle==0)
+		ceder();
+	printf("abandona: termina con sus hilos vivos\n");
+	return 0;
+}
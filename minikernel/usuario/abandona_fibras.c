@@ -0,0 +1,37 @@
+/*
+ * usuario/abandona_fibras.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que termina con salir desde una fibra, ejecutando
+ * sobre su pila, y dejando otras dormidas. Mientras duerme, prueba_fibras
+ * llena la reserva de pilas, así que las suyas no caben en ella cuando el
+ * núcleo las recoge.
+ */
+
+#include "servicios.h"
+
+static int dormida(void *arg){
+	fibra_dormir_ms(5000);
+	printf("abandona_fibras: la fibra dormida sigue. NO DEBE APARECER\n");
+	return 0;
+}
+
+static int saliente(void *arg){
+	fibra_dormir_ms(1000);
+	salir(7);
+	return 0;
+}
+
+int main(){
+	fibra_crear(dormida, 0);
+	fibra_crear(dormida, 0);
+	fibra_esperar(fibra_crear(saliente, 0), 0);
+	printf("abandona_fibras: sigue tras salir. NO DEBE APARECER\n");
+	return 0;
+}
@@ -0,0 +1,34 @@
+/*
+ * usuario/contador.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que cuenta en una variable global, cediendo el
+ * procesador entre cuenta y cuenta. Si varios procesos que lo ejecutan
+ * compartieran sus datos, se verían las cuentas de los otros.
+ */
+
+#include "servicios.h"
+
+#define CUENTAS 5
+
+int cuenta;		/* en bss */
+int paso=1;		/* en datos */
+
+int main(){
+	int i, id;
+
+	id=obtener_id_pr();
+	for (i=0; i<CUENTAS; i++) {
+		cuenta+=paso;
+		dormir_ms(10);
+	}
+	printf("contador (%d): cuenta %d %s\n", id, cuenta,
+		cuenta==CUENTAS ? "BIEN" : "MAL");
+	return 0;
+}
@@ -0,0 +1,28 @@
+/*
+ * usuario/cortes.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que cede el procesador tras cada vuelta.
+ */
+
+#include "servicios.h"
+
+#define VUELTAS 5
+
+int main(){
+	int i, id;
+
+	id=obtener_id_pr();
+	for (i=0; i<VUELTAS; i++) {
+		printf("cortes (%d): vuelta %d\n", id, i);
+		ceder();
+	}
+	printf("cortes (%d): termina\n", id);
+	return 0;
+}
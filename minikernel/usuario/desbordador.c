@@ -0,0 +1,32 @@
+/*
+ * usuario/desbordador.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que desborda su pila con una recursión que, con
+ * 1 KB por nivel, no llega a su final. Debe terminar con una excepción
+ * de memoria.
+ */
+
+#include "servicios.h"
+
+static int bajar(int nivel){
+	volatile char hueco[1024];
+
+	hueco[0]=nivel;
+	if (nivel==1000000)
+		return 0;
+	return bajar(nivel+1)+hueco[0];
+}
+
+int main(){
+	printf("desbordador: comienza\n");
+	bajar(0);
+	printf("desbordador: NO DEBE APARECER\n");
+	return 0;
+}
@@ -0,0 +1,33 @@
+/*
+ * usuario/despertador.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que duerme muchas veces intervalos cortos, cada
+ * proceso con un intervalo distinto, para que sus despertares caigan en
+ * ticks diferentes si no tiene holgura. El intervalo es un número impar
+ * de ticks menos medio tick, para no pasar al siguiente por la parte ya
+ * transcurrida del tick en curso.
+ */
+
+#include "servicios.h"
+
+#define VUELTAS 10
+
+int main(){
+	int i, id;
+	unsigned long long ini, fin;
+
+	id=obtener_id_pr();
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	for (i=0; i<VUELTAS; i++)
+		dormir_us((2*id+3)*10000-5000);
+	obtener_tiempo(RELOJ_MONOTONO, &fin);
+	printf("despertador (%d): %d vueltas en %llu us\n", id, VUELTAS, fin-ini);
+	return 0;
+}
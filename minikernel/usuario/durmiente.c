@@ -0,0 +1,20 @@
+/*
+ * usuario/durmiente.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que sólo ocupa una entrada de la tabla de procesos
+ * durante un rato y termina
+ */
+
+#include "servicios.h"
+
+int main(){
+	dormir(5);
+	return 0;
+}
@@ -0,0 +1,19 @@
+/*
+ * usuario/efimero.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que sólo duerme un momento y termina
+ */
+
+#include "servicios.h"
+
+int main(){
+	dormir_ms(200);
+	return 0;
+}
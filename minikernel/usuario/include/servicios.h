@@ -26,7 +26,7 @@
 int escribirf(const char *formato, ...);
 
 /* Llamadas al sistema proporcionadas */
-int crear_proceso(char *prog);
+int crear_proceso(char *prog); //A11: devuelve el identificador del nuevo proceso.
 int terminar_proceso();
 int escribir(char *texto, unsigned int longi);
 int obtener_id_pr(); //A0: Esta funcionalidad no es de la práctica pero se ha añadido para aprender a añadir llamadas al sistema.
@@ -40,5 +40,95 @@ int abrir_mutex(char *nombre);
 int lock(unsigned int mutexid);
 int unlock(unsigned int mutexid);
 int cerrar_mutex(unsigned int mutexid);
+
+/* A4: niveles de prioridad, de 0 (más prioritario) a 7 */
+int fijar_prioridad(int prioridad);
+
+/* A7: clase de tiempo real (EDF). Tiempos en milisegundos; periodo 0
+   devuelve el proceso a la clase normal */
+int fijar_tiempo_real(unsigned int periodo, unsigned int presupuesto, unsigned int plazo);
+
+/* A9: crea un grupo de reparto de CPU dentro del actual y entra en él.
+   reparto es un porcentaje de la CPU del grupo padre y cuota el máximo
+   de ticks por ventana (0 sin cuota) */
+int crear_grupo(int reparto, int cuota);
+
+/* A11: ceder el procesador, a cualquiera o a un proceso concreto */
+int ceder();
+int ceder_a(int pid);
+
+/* A14: esperas con resolución de un tick y lectura de relojes. La
+   espera nunca es más corta que lo pedido y se pasa menos de un tick.
+   obtener_tiempo guarda en tiempo los microsegundos desde el arranque
+   según el reloj del sistema (monótono) o el del hardware (CMOS) */
+#define RELOJ_MONOTONO 0
+#define RELOJ_CMOS 1
+
+int dormir_ms(unsigned int ms);
+int dormir_us(unsigned int us);
+int obtener_tiempo(int reloj, unsigned long long *tiempo);
+
+/* A15: espera hasta un instante absoluto del reloj monótono y
+   temporizador periódico del proceso (periodo en microsegundos, 0 lo
+   desarma). esperar_temporizador devuelve los vencimientos desde la
+   espera anterior: más de 1 si se han perdido periodos */
+int dormir_hasta(unsigned long long instante);
+int fijar_temporizador(unsigned int periodo);
+int esperar_temporizador();
+
+/* A16: microsegundos que puede retrasarse un despertar para agruparlo
+   con otros. Devuelve la holgura anterior; los hijos la heredan */
+int fijar_holgura(unsigned int holgura);
+
+/* A23: un programa que necesita una pila distinta de la normal (32 KB)
+   pone TAMANO_PILA(bytes); en global. Se redondea a una potencia de dos
+   entre 16 KB y 256 KB, y si pide más no se puede crear */
+#define TAMANO_PILA(tam) const unsigned int tam_pila=(tam)
+
+/* A24: crea n procesos del programa en una sola llamada. Deja en pids el
+   identificador de cada uno (-1 si ese no se ha podido crear) y devuelve
+   cuántos ha creado, o -1 si n o pids no son válidos */
+int crear_procesos(char *prog, int n, int *pids);
+
+/* A25: terminar con un estado que recoge el padre con esperar_proceso.
+   terminar_proceso, y volver de main, terminan con estado 0; morir por
+   una excepción, con -1. esperar_proceso espera al hijo pid, o a
+   cualquiera con ESPERA_CUALQUIERA, y devuelve su identificador, o -1
+   si no tiene ese hijo o ninguno */
+#define ESPERA_CUALQUIERA -1
+
+int salir(int estado);
+int esperar_proceso(int pid, int *estado);
+/* A26: como crear_proceso, pero si la tabla de procesos está llena
+   espera a que quede sitio, sin límite (ESPERA_INDEFINIDA) o como mucho
+   ms milisegundos. Devuelve -1 si se acaba el plazo */
+#define ESPERA_INDEFINIDA -1
+int crear_proceso_espera(char *prog, int ms);
+/* A27: hilos del proceso. Comparten las variables globales, los mutex
+   abiertos y los hijos, pero cada uno tiene su pila. El hilo ejecuta
+   funcion(arg) y termina con lo que devuelva, o con salir. Otro hilo del
+   proceso recoge ese estado con esperar_hilo. Una excepción o
+   terminar_proceso en un hilo sólo terminan ese hilo, y cuando termina
+   el proceso mueren los hilos que le queden */
+int crear_hilo(int (*funcion)(void *), void *arg);
+int esperar_hilo(int id, int *estado);
+
+/* A28: lock que no se bloquea: devuelve 1 si el mutex lo tiene otro */
+int intentar_lock(unsigned int mutexid);
+
+/* A28: fibras. Varias funciones que se turnan en un mismo proceso (o
+   hilo) sin pasar por el núcleo: una fibra sigue hasta que cede, espera
+   a otra, duerme o se para en un mutex, y entonces pasa a la siguiente
+   lista. La fibra inicial es la que llama por primera vez; las demás
+   reciben un identificador mayor que 0. fibra_dormir y fibra_lock sólo
+   paran la fibra si hay otra que ejecutar; si no, esperan en el núcleo.
+   No deben usarse desde varios hilos del mismo proceso */
+int fibra_crear(int (*funcion)(void *), void *arg);
+int fibra_ceder();
+int fibra_esperar(int id, int *resultado);
+int fibra_dormir(unsigned int segundos);
+int fibra_dormir_ms(unsigned int ms);
+int fibra_lock(unsigned int mutexid);
+int fibra_unlock(unsigned int mutexid);
 #endif /* SERVICIOS_H */
 
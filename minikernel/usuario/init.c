@@ -90,6 +90,96 @@ ALGO COMENTE ESTA PARTE Y DESCOMENTE LA PRUEBA CORRESPONDIENTE */
 		printf("Error creando prueba_term\n");
 */
 
+/* PRUEBA DE PRIORIDADES
+	if (crear_proceso("prueba_prio")<0)
+		printf("Error creando prueba_prio\n");
+*/
+
+/* PRUEBA DE LA POLITICA MLFQ (arrancar con PLANIFICADOR=mlfq)
+	if (crear_proceso("prueba_MLFQ")<0)
+		printf("Error creando prueba_MLFQ\n");
+*/
+
+/* PRUEBA DE LA POLITICA CFS (arrancar con PLANIFICADOR=cfs)
+	if (crear_proceso("prueba_CFS")<0)
+		printf("Error creando prueba_CFS\n");
+*/
+
+/* PRUEBA DE TIEMPO REAL
+	if (crear_proceso("prueba_TR")<0)
+		printf("Error creando prueba_TR\n");
+*/
+
+/* PRUEBA DE GRUPOS DE REPARTO DE CPU
+	if (crear_proceso("prueba_grupos")<0)
+		printf("Error creando prueba_grupos\n");
+*/
+
+/* PRUEBA DE CEDER EL PROCESADOR
+	if (crear_proceso("prueba_ceder")<0)
+		printf("Error creando prueba_ceder\n");
+*/
+
+/* PRUEBA DE ESPERAS CORTAS Y RELOJES
+	if (crear_proceso("prueba_tiempo")<0)
+		printf("Error creando prueba_tiempo\n");
+*/
+
+/* PRUEBA DE ESPERAS ABSOLUTAS Y TEMPORIZADORES
+	if (crear_proceso("prueba_temporizador")<0)
+		printf("Error creando prueba_temporizador\n");
+*/
+
+/* PRUEBA DE HOLGURA DE LOS TEMPORIZADORES
+	if (crear_proceso("prueba_holgura")<0)
+		printf("Error creando prueba_holgura\n");
+*/
+
+/* PRUEBA DE MUCHOS PROCESOS
+	if (crear_proceso("prueba_procesos")<0)
+		printf("Error creando prueba_procesos\n");
+*/
+
+/* MEDIDA DEL COSTE DE RECORRER LA TABLA DE PROCESOS
+	if (crear_proceso("prueba_recorrido")<0)
+		printf("Error creando prueba_recorrido\n");
+*/
+
+/* PRUEBA DE LA CACHE DE IMAGENES
+	if (crear_proceso("prueba_imagenes")<0)
+		printf("Error creando prueba_imagenes\n");
+*/
+
+/* PRUEBA DE TAMAÑOS Y DESBORDAMIENTO DE PILAS
+	if (crear_proceso("prueba_pilas")<0)
+		printf("Error creando prueba_pilas\n");
+*/
+
+/* PRUEBA DE CREACION DE PROCESOS EN LOTE
+	if (crear_proceso("prueba_lotes")<0)
+		printf("Error creando prueba_lotes\n");
+*/
+
+/* PRUEBA DE ESPERA POR LOS HIJOS
+	if (crear_proceso("prueba_esperar")<0)
+		printf("Error creando prueba_esperar\n");
+*/
+
+/* PRUEBA DE CREACION CON LA TABLA DE PROCESOS LLENA
+	if (crear_proceso("prueba_tabla_llena")<0)
+		printf("Error creando prueba_tabla_llena\n");
+*/
+
+/* PRUEBA DE HILOS
+	if (crear_proceso("prueba_hilos")<0)
+		printf("Error creando prueba_hilos\n");
+*/
+
+/* PRUEBA DE FIBRAS
+	if (crear_proceso("prueba_fibras")<0)
+		printf("Error creando prueba_fibras\n");
+*/
+
 	printf("init: termina\n");
 	return 0; 
 }
@@ -0,0 +1,32 @@
+/*
+ * usuario/inquilino.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que crea un grupo de reparto de CPU con la mitad
+ * de la CPU y una cuota de 10 ticks por ventana, y lanza en él varios
+ * procesos mudo, que lo heredan.
+ */
+
+#include "servicios.h"
+
+#define NUM_HIJOS 3
+
+int main(){
+	int i, grupo;
+
+	grupo=crear_grupo(50, 10);
+	printf("inquilino (%d): grupo %d\n", obtener_id_pr(), grupo);
+
+	for (i=0; i<NUM_HIJOS; i++)
+		if (crear_proceso("mudo")<0)
+			printf("Error creando mudo\n");
+
+	printf("inquilino (%d): termina\n", obtener_id_pr());
+	return 0;
+}
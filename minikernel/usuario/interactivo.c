@@ -0,0 +1,36 @@
+/*
+ * usuario/interactivo.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que sube su prioridad y se despierta
+ * periódicamente. Debe expulsar a los procesos menos prioritarios.
+ */
+
+#include "servicios.h"
+
+#define TOT_ITER 5
+
+int main(){
+	int i, id, anterior;
+
+	id=obtener_id_pr();
+	if ((anterior=fijar_prioridad(1))<0)
+		printf("interactivo (%d): error fijando prioridad. NO DEBE SALIR\n", id);
+	printf("interactivo (%d): prioridad 1 (antes %d)\n", id, anterior);
+
+	if (fijar_prioridad(8)>=0)
+		printf("interactivo (%d): prioridad 8 aceptada. NO DEBE SALIR\n", id);
+
+	for (i=0; i<TOT_ITER; i++){
+		dormir(1);
+		printf("interactivo (%d): despierta %d\n", id, i);
+	}
+	printf("interactivo (%d): termina\n", id);
+	return 0;
+}
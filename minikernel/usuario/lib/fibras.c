@@ -0,0 +1,350 @@
+/*
+ *  usuario/lib/fibras.c
+ *
+ *  A28: fibras de la biblioteca
+ *
+ */
+
+/*
+ *
+ * Fichero que contiene un planificador cooperativo de fibras dentro de
+ * un proceso. Cambiar de fibra es guardar los registros que conserva una
+ * llamada a función y cambiar el puntero de pila, sin llamada al sistema:
+ * sólo se entra en el núcleo para pedir la pila de una fibra nueva, para
+ * dormir o esperar un mutex cuando no hay otra fibra que ejecutar y para
+ * leer el reloj mientras haya fibras dormidas.
+ *
+ */
+
+#include "llamsis.h"
+#include "servicios.h"
+
+int llamsis(int llamada, int nargs, ... /* args */);
+
+#define MAX_FIBRAS 16		/* contando la inicial; pilas: MAX_PILAS_FIBRAS */
+#define NUM_DESCRIPTORES 4	/* mutex abiertos por proceso (NUM_MUT_PROC) */
+
+/* estados de una fibra */
+#define LIBRE 0
+#define LISTA 1
+#define DORMIDA 2
+#define BLOQUEADA 3		/* esperando a otra fibra o un mutex */
+#define TERMINADA 4		/* hasta que otra la espere */
+
+typedef struct {
+	void *sp;			/* pila guardada mientras no ejecuta */
+	int estado;
+	int (*funcion)(void *);
+	void *arg;
+	int resultado;
+	unsigned long long despertar;	/* si está dormida */
+	int esperada;			/* fibra a la que espera, o -1 */
+	int cerrojo;			/* mutex que espera, o -1 */
+	void *pila;			/* se reutiliza para la siguiente fibra */
+	int tam_pila;
+} fibra;
+
+static fibra fibras[MAX_FIBRAS];
+static int actual;		/* la inicial es la 0 */
+static int iniciadas;
+static int num_dormidas;
+
+/* qué fibra tiene cada mutex del proceso y cuántas veces lo ha cogido */
+static struct {
+	int dueno;
+	int veces;
+} cerrojos[NUM_DESCRIPTORES];
+
+/*
+ * Guarda en *guardar la pila de la fibra actual con sus registros y
+ * continúa por la pila nueva, que tiene que estar igual. Una fibra nueva
+ * empieza con los registros a 0 y arranque_fibra como dirección de
+ * retorno.
+ */
+void cambiar_fibra(void **guardar, void *nueva) __attribute__((visibility("hidden")));
+
+#if defined(__x86_64__)
+#define NUM_REGISTROS 6
+__asm__(
+	".text\n"
+	".globl cambiar_fibra\n"
+	".hidden cambiar_fibra\n"
+	".type cambiar_fibra,@function\n"
+"cambiar_fibra:\n"
+	"pushq %rbp\n"
+	"pushq %rbx\n"
+	"pushq %r12\n"
+	"pushq %r13\n"
+	"pushq %r14\n"
+	"pushq %r15\n"
+	"movq %rsp,(%rdi)\n"
+	"movq %rsi,%rsp\n"
+	"popq %r15\n"
+	"popq %r14\n"
+	"popq %r13\n"
+	"popq %r12\n"
+	"popq %rbx\n"
+	"popq %rbp\n"
+	"ret\n"
+	".size cambiar_fibra,.-cambiar_fibra\n");
+#elif defined(__i386__)
+#define NUM_REGISTROS 4
+__asm__(
+	".text\n"
+	".globl cambiar_fibra\n"
+	".hidden cambiar_fibra\n"
+	".type cambiar_fibra,@function\n"
+"cambiar_fibra:\n"
+	"movl 4(%esp),%eax\n"
+	"movl 8(%esp),%edx\n"
+	"pushl %ebp\n"
+	"pushl %ebx\n"
+	"pushl %esi\n"
+	"pushl %edi\n"
+	"movl %esp,(%eax)\n"
+	"movl %edx,%esp\n"
+	"popl %edi\n"
+	"popl %esi\n"
+	"popl %ebx\n"
+	"popl %ebp\n"
+	"ret\n"
+	".size cambiar_fibra,.-cambiar_fibra\n");
+#else
+#error "fibras: arquitectura no soportada"
+#endif
+
+/* la primera llamada convierte en fibra 0 a quien llama */
+static void iniciar(){
+	int i;
+
+	if (iniciadas)
+		return;
+	iniciadas=1;
+	actual=0;
+	fibras[0].estado=LISTA;
+	fibras[0].esperada=fibras[0].cerrojo=-1;
+	for (i=0; i<NUM_DESCRIPTORES; i++)
+		cerrojos[i].dueno=-1;
+}
+
+static void cambiar_a(int sig){
+	int ant=actual;
+
+	if (sig==ant)
+		return;
+	actual=sig;
+	cambiar_fibra(&fibras[ant].sp, fibras[sig].sp);
+}
+
+/* pasa a LISTA las dormidas que ya han vencido y devuelve el vencimiento
+   más próximo de las que quedan */
+static unsigned long long despertar_dormidas(){
+	unsigned long long ahora, primero=~0ULL;
+	int i;
+
+	obtener_tiempo(RELOJ_MONOTONO, &ahora);
+	for (i=0; i<MAX_FIBRAS; i++) {
+		if (fibras[i].estado!=DORMIDA)
+			continue;
+		if (fibras[i].despertar<=ahora) {
+			fibras[i].estado=LISTA;
+			num_dormidas--;
+		}
+		else if (fibras[i].despertar<primero)
+			primero=fibras[i].despertar;
+	}
+	return primero;
+}
+
+/*
+ * Pasa a la siguiente fibra lista (la actual si es la única). Si no hay
+ * ninguna pero hay dormidas, duerme el proceso hasta la primera que
+ * vence. Devuelve -1 si ninguna puede volver a ejecutar.
+ */
+static int planificar(){
+	unsigned long long primero=0;
+	int i, sig;
+
+	for (;;) {
+		if (num_dormidas>0)
+			primero=despertar_dormidas();
+		for (i=1; i<=MAX_FIBRAS; i++) {
+			sig=(actual+i)%MAX_FIBRAS;
+			if (fibras[sig].estado==LISTA) {
+				cambiar_a(sig);
+				return 0;
+			}
+		}
+		if (num_dormidas==0)
+			return -1;
+		dormir_hasta(primero);
+	}
+}
+
+static int hay_otra_lista(){
+	int i;
+
+	for (i=0; i<MAX_FIBRAS; i++)
+		if (i!=actual && fibras[i].estado==LISTA)
+			return 1;
+	return 0;
+}
+
+/* una fibra nueva empieza aquí y, al terminar su función, pasa a otra */
+static void arranque_fibra(){
+	fibra *f=&fibras[actual];
+	int i;
+
+	f->resultado=f->funcion(f->arg);
+	f->estado=TERMINADA;
+	for (i=0; i<MAX_FIBRAS; i++)
+		if (fibras[i].estado==BLOQUEADA && fibras[i].esperada==actual) {
+			fibras[i].estado=LISTA;
+			fibras[i].esperada=-1;
+		}
+	if (planificar()<0) {
+		printf("fibras: las que quedan no pueden continuar\n");
+		terminar_proceso();
+	}
+}
+
+int fibra_crear(int (*funcion)(void *), void *arg){
+	fibra *f;
+	void **sp;
+	int i;
+
+	iniciar();
+	for (i=1; i<MAX_FIBRAS && fibras[i].estado!=LIBRE; i++);
+	if (i==MAX_FIBRAS)
+		return -1;
+	f=&fibras[i];
+	if (!f->pila &&
+	    llamsis(PEDIR_PILA, 2, (long)&f->pila, (long)&f->tam_pila)<0)
+		return -1;
+
+	/* como si arranque_fibra fuera a volver de cambiar_fibra; la pila
+	   queda alineada como la deja una llamada */
+	sp=(void **)(((unsigned long)f->pila+f->tam_pila)&~15UL);
+	*--sp=0;
+	*--sp=(void *)arranque_fibra;
+	for (int r=0; r<NUM_REGISTROS; r++)
+		*--sp=0;
+	f->sp=sp;
+	f->funcion=funcion;
+	f->arg=arg;
+	f->esperada=f->cerrojo=-1;
+	f->estado=LISTA;
+	return i;
+}
+
+int fibra_ceder(){
+	iniciar();
+	return planificar();
+}
+
+int fibra_esperar(int id, int *resultado){
+	fibra *f=&fibras[actual];
+
+	iniciar();
+	if (id<=0 || id>=MAX_FIBRAS || id==actual)
+		return -1;
+	while (fibras[id].estado!=TERMINADA) {
+		if (fibras[id].estado==LIBRE) //no existe o ya la ha esperado otra
+			return -1;
+		f->estado=BLOQUEADA;
+		f->esperada=id;
+		if (planificar()<0) {
+			f->estado=LISTA;
+			f->esperada=-1;
+			return -1;
+		}
+	}
+	if (resultado)
+		*resultado=fibras[id].resultado;
+	fibras[id].estado=LIBRE;
+	return id;
+}
+
+int fibra_dormir_ms(unsigned int ms){
+	fibra *f=&fibras[actual];
+	unsigned long long ahora;
+
+	iniciar();
+	if (!hay_otra_lista() && num_dormidas==0)
+		return dormir_ms(ms);
+	obtener_tiempo(RELOJ_MONOTONO, &ahora);
+	f->despertar=ahora+ms*1000ULL;
+	f->estado=DORMIDA;
+	num_dormidas++;
+	return planificar();
+}
+
+int fibra_dormir(unsigned int segundos){
+	return fibra_dormir_ms(segundos*1000);
+}
+
+/*
+ * Si el mutex lo tiene otra fibra del proceso, ésta se para hasta que lo
+ * suelte. Si lo tiene otro proceso se pasa a otra fibra y se vuelve a
+ * intentar, salvo que no haya otra lista: entonces se espera en el núcleo.
+ */
+int fibra_lock(unsigned int mutexid){
+	fibra *f=&fibras[actual];
+	int r;
+
+	iniciar();
+	if (mutexid>=NUM_DESCRIPTORES)
+		return -1;
+	if (cerrojos[mutexid].dueno==actual) {
+		if (lock(mutexid)<0)
+			return -1;
+		cerrojos[mutexid].veces++;
+		return 0;
+	}
+	for (;;) {
+		while (cerrojos[mutexid].dueno!=-1) {
+			f->estado=BLOQUEADA;
+			f->cerrojo=mutexid;
+			if (planificar()<0) {
+				f->estado=LISTA;
+				f->cerrojo=-1;
+				return -1;
+			}
+		}
+		r=intentar_lock(mutexid);
+		if (r!=1)
+			break;
+		if (!hay_otra_lista()) {
+			r=lock(mutexid);
+			break;
+		}
+		planificar();
+	}
+	if (r<0)
+		return -1;
+	cerrojos[mutexid].dueno=actual;
+	cerrojos[mutexid].veces=1;
+	return 0;
+}
+
+int fibra_unlock(unsigned int mutexid){
+	int i, sig;
+
+	iniciar();
+	if (mutexid>=NUM_DESCRIPTORES || cerrojos[mutexid].dueno!=actual)
+		return -1;
+	if (unlock(mutexid)<0)
+		return -1;
+	if (--cerrojos[mutexid].veces>0)
+		return 0;
+	cerrojos[mutexid].dueno=-1;
+	for (i=1; i<MAX_FIBRAS; i++) {
+		sig=(actual+i)%MAX_FIBRAS;
+		if (fibras[sig].estado==BLOQUEADA && fibras[sig].cerrojo==(int)mutexid) {
+			fibras[sig].estado=LISTA;
+			fibras[sig].cerrojo=-1;
+			break;
+		}
+	}
+	return 0;
+}
@@ -38,7 +38,7 @@ int crear_proceso(char *prog){
 	return llamsis(CREAR_PROCESO, 1, (long)prog);
 }
 int terminar_proceso(){
-	return llamsis(TERMINAR_PROCESO, 0);
+	return llamsis(TERMINAR_PROCESO, 1, 0L); //A25: termina con estado 0.
 }
 int escribir(char *texto, unsigned int longi){
 	return llamsis(ESCRIBIR, 2, (long)texto, (long)longi);
@@ -63,4 +63,71 @@ int unlock(unsigned int mutexid){
 }
 int cerrar_mutex(unsigned int mutexid){
 	return llamsis(CERRAR_MUTEX, 1, (long)mutexid);
+}
+int fijar_prioridad(int prioridad){
+	return llamsis(FIJAR_PRIORIDAD, 1, (long)prioridad);
+}
+int fijar_tiempo_real(unsigned int periodo, unsigned int presupuesto, unsigned int plazo){
+	return llamsis(FIJAR_TIEMPO_REAL, 3, (long)periodo, (long)presupuesto, (long)plazo);
+}
+int crear_grupo(int reparto, int cuota){
+	return llamsis(CREAR_GRUPO, 2, (long)reparto, (long)cuota);
+}
+int ceder(){
+	return llamsis(CEDER, 0);
+}
+int ceder_a(int pid){
+	return llamsis(CEDER_A, 1, (long)pid);
+}
+int dormir_ms(unsigned int ms){
+	return llamsis(DORMIR_MS, 1, (long)ms);
+}
+int dormir_us(unsigned int us){
+	return llamsis(DORMIR_US, 1, (long)us);
+}
+int obtener_tiempo(int reloj, unsigned long long *tiempo){
+	return llamsis(OBTENER_TIEMPO, 2, (long)reloj, (long)tiempo);
+}
+int dormir_hasta(unsigned long long instante){
+	return llamsis(DORMIR_HASTA, 1, (long)instante);
+}
+int fijar_temporizador(unsigned int periodo){
+	return llamsis(FIJAR_TEMPORIZADOR, 1, (long)periodo);
+}
+int esperar_temporizador(){
+	return llamsis(ESPERAR_TEMPORIZADOR, 0);
+}
+int fijar_holgura(unsigned int holgura){
+	return llamsis(FIJAR_HOLGURA, 1, (long)holgura);
+}
+int crear_procesos(char *prog, int n, int *pids){
+	return llamsis(CREAR_PROCESOS, 3, (long)prog, (long)n, (long)pids);
+}
+int salir(int estado){
+	return llamsis(TERMINAR_PROCESO, 1, (long)estado);
+}
+int esperar_proceso(int pid, int *estado){
+	return llamsis(ESPERAR_PROCESO, 2, (long)pid, (long)estado);
+}
+int crear_proceso_espera(char *prog, int ms){
+	return llamsis(CREAR_PROCESO_ESPERA, 2, (long)prog, (long)ms);
+}
+
+/* A27: un hilo empieza aquí: pide la función y el argumento con los que
+   se ha creado y termina con lo que devuelva la función */
+static void inicio_hilo(){
+	int (*funcion)(void *);
+	void *arg;
+
+	llamsis(ARRANCAR_HILO, 2, (long)&funcion, (long)&arg);
+	salir(funcion(arg));
+}
+int crear_hilo(int (*funcion)(void *), void *arg){
+	return llamsis(CREAR_HILO, 3, (long)inicio_hilo, (long)funcion, (long)arg);
+}
+int esperar_hilo(int id, int *estado){
+	return llamsis(ESPERAR_HILO, 2, (long)id, (long)estado);
+}
+int intentar_lock(unsigned int mutexid){
+	return llamsis(INTENTAR_LOCK, 1, (long)mutexid);
 }
\ No newline at end of file
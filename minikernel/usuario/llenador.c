@@ -0,0 +1,32 @@
+/*
+ * usuario/llenador.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que llena la tabla de procesos de procesos
+ * durmiente y termina con el número que ha creado como estado. Sus
+ * hijos se quedan sin padre, así que sus entradas se liberan en cuanto
+ * terminan.
+ */
+
+#include "servicios.h"
+
+#define POR_LOTE 500
+
+int main(){
+	int pids[POR_LOTE], n, total=0;
+
+	do {
+		n=crear_procesos("durmiente", POR_LOTE, pids);
+		if (n>0)
+			total+=n;
+	} while (n==POR_LOTE);
+	printf("llenador: %d procesos creados\n", total);
+	salir(total);
+	return 0;
+}
@@ -0,0 +1,36 @@
+/*
+ * usuario/periodico.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que se declara de tiempo real (periodo de 1 s,
+ * 200 ms de presupuesto y plazo de 500 ms) y en cada periodo hace un
+ * poco de trabajo y se duerme.
+ */
+
+#include "servicios.h"
+
+#define TOT_PERIODOS 4
+#define ITER_TRABAJO 10000000	/* bastante menos que el presupuesto */
+
+int main(){
+	int i, j, id, tot=0;
+
+	id=obtener_id_pr();
+	if (fijar_tiempo_real(1000, 200, 500)<0)
+		printf("periodico (%d): no admitido. NO DEBE SALIR\n", id);
+
+	for (i=0; i<TOT_PERIODOS; i++){
+		for (j=0; j<ITER_TRABAJO; j++)
+			tot=(tot+j)%1000;
+		printf("periodico (%d): periodo %d hecho\n", id, i);
+		dormir(1);
+	}
+	printf("periodico (%d): termina con %d\n", id, tot);
+	return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * usuario/prueba_CFS.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de la política CFS. Crea procesos
+ * mudo con distinta prioridad (la heredan del creador), que deben recibir
+ * un reparto de CPU proporcional a su peso: terminarán primero los más
+ * prioritarios aunque todos progresan a la vez.
+ */
+
+#include "servicios.h"
+
+int main(){
+	int prio;
+
+	printf("prueba_CFS: comienza\n");
+
+	for (prio=6; prio>=2; prio-=2) {
+		fijar_prioridad(prio);
+		if (crear_proceso("mudo")<0)
+			printf("Error creando mudo\n");
+	}
+
+	printf("prueba_CFS: termina\n");
+	return 0;
+}
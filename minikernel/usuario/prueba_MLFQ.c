@@ -0,0 +1,33 @@
+/*
+ * usuario/prueba_MLFQ.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de la política MLFQ mezclando
+ * procesos que gastan CPU con procesos que duermen. Los mudo deben ir
+ * bajando de nivel y los dormilon ejecutar en cuanto se despiertan.
+ */
+
+#include "servicios.h"
+
+int main(){
+	int i;
+
+	printf("prueba_MLFQ: comienza\n");
+
+	for (i=1; i<=3; i++)
+		if (crear_proceso("mudo")<0)
+			printf("Error creando mudo\n");
+
+	for (i=1; i<=2; i++)
+		if (crear_proceso("dormilon")<0)
+			printf("Error creando dormilon\n");
+
+	printf("prueba_MLFQ: termina\n");
+	return 0;
+}
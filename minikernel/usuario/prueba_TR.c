@@ -0,0 +1,41 @@
+/*
+ * usuario/prueba_TR.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de la clase de tiempo real.
+ * Comprueba el control de admisión y arranca dos procesos periódicos
+ * junto con procesos que gastan CPU, que no deben hacerles perder plazos.
+ */
+
+#include "servicios.h"
+
+int main(){
+	int i;
+
+	printf("prueba_TR: comienza\n");
+
+	/* 95% de utilización: supera el máximo admitido */
+	if (fijar_tiempo_real(1000, 950, 1000)<0)
+		printf("prueba_TR: reserva del 95%% rechazada. DEBE SALIR\n");
+
+	/* el presupuesto no puede superar el plazo */
+	if (fijar_tiempo_real(1000, 600, 500)<0)
+		printf("prueba_TR: parametros incoherentes. DEBE SALIR\n");
+
+	for (i=1; i<=2; i++)
+		if (crear_proceso("mudo")<0)
+			printf("Error creando mudo\n");
+
+	for (i=1; i<=2; i++)
+		if (crear_proceso("periodico")<0)
+			printf("Error creando periodico\n");
+
+	printf("prueba_TR: termina\n");
+	return 0;
+}
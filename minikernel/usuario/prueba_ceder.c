@@ -0,0 +1,41 @@
+/*
+ * usuario/prueba_ceder.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de ceder y ceder_a. Crea
+ * dos procesos cortes, que se alternan vuelta a vuelta porque ceden el
+ * procesador en cada una, y cede su turno al segundo, que debe empezar
+ * antes que el primero.
+ */
+
+#include "servicios.h"
+
+int main(){
+	int pid;
+
+	printf("prueba_ceder: comienza\n");
+
+	if (crear_proceso("cortes")<0)
+		printf("Error creando cortes\n");
+	if ((pid=crear_proceso("cortes"))<0)
+		printf("Error creando cortes\n");
+
+	printf("prueba_ceder: cede su turno a %d\n", pid);
+	if (ceder_a(pid)<0)
+		printf("error en ceder_a. NO DEBE APARECER\n");
+
+	/* a sí mismo no tiene efecto y a uno que no existe es un error */
+	if (ceder_a(obtener_id_pr())<0)
+		printf("error en ceder_a a sí mismo. NO DEBE APARECER\n");
+	if (ceder_a(-1)<0)
+		printf("error en ceder_a a un proceso que no existe. DEBE APARECER\n");
+
+	printf("prueba_ceder: termina\n");
+	return 0;
+}
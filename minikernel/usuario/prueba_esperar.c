@@ -0,0 +1,67 @@
+/*
+ * usuario/prueba_esperar.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que prueba esperar_proceso: espera a hijos
+ * concretos y a cualquiera, recoge uno que ya es zombi, el estado de uno
+ * que muere por una excepción y los casos en que no hay a quién esperar.
+ */
+
+#include "servicios.h"
+
+#define HIJOS 5
+
+int main(){
+	int i, pid, estado, pids[HIJOS], mal=0;
+
+	printf("prueba_esperar: comienza\n");
+
+	/* hijos concretos, en orden de creación */
+	for (i=0; i<3; i++)
+		pids[i]=crear_proceso("saliente");
+	for (i=0; i<3; i++) {
+		pid=esperar_proceso(pids[i], &estado);
+		if (pid!=pids[i] || estado!=pid%100)
+			mal++;
+		printf("prueba_esperar: hijo %d termina con %d\n", pid, estado);
+	}
+
+	/* un hijo que ya ha terminado cuando se le espera */
+	pid=crear_proceso("saliente");
+	dormir_ms(200);
+	if (esperar_proceso(pid, &estado)!=pid || estado!=pid%100)
+		mal++;
+
+	/* un hijo que muere por una excepción */
+	pid=crear_proceso("excep_arit");
+	if (esperar_proceso(pid, &estado)!=pid || estado!=-1)
+		mal++;
+	printf("prueba_esperar: excep_arit termina con %d\n", estado);
+
+	/* cualquiera, de un lote */
+	crear_procesos("saliente", HIJOS, pids);
+	for (i=0; i<HIJOS; i++) {
+		pid=esperar_proceso(ESPERA_CUALQUIERA, &estado);
+		if (pid<0 || estado!=pid%100)
+			mal++;
+		printf("prueba_esperar: hijo %d termina con %d\n", pid, estado);
+	}
+
+	/* no queda ningún hijo; el propio proceso no es hijo suyo */
+	if (esperar_proceso(ESPERA_CUALQUIERA, 0)>=0)
+		mal++;
+	if (esperar_proceso(obtener_id_pr(), 0)>=0)
+		mal++;
+	if (esperar_proceso(pids[0], 0)>=0) /* ya recogido */
+		mal++;
+
+	printf("prueba_esperar: %d errores (debe ser 0)\n", mal);
+	printf("prueba_esperar: termina\n");
+	return 0;
+}
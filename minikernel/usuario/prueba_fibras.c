@@ -0,0 +1,146 @@
+/*
+ * usuario/prueba_fibras.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que prueba las fibras de la biblioteca: se turnan
+ * al ceder, fibra_esperar recoge lo que devuelven, fibra_lock para sólo
+ * a la fibra que no lo consigue y fibra_dormir_ms deja ejecutar a las
+ * demás mientras tanto. abandona_fibras termina desde una fibra con la
+ * reserva de pilas del núcleo llena. Al final compara lo que cuesta pasar
+ * de una fibra a otra con lo que cuesta pasar de un hilo a otro con
+ * ceder, que entra en el núcleo y hace un cambio de contexto.
+ */
+
+#include "servicios.h"
+
+#define NFIBRAS 4
+#define VUELTAS 50
+#define CAMBIOS_FIBRAS 100000
+#define CAMBIOS_HILOS 2000
+#define EFIMEROS 40
+
+int mutex, total, orden[2], num_orden, vueltas_libre;
+volatile int durmiendo;
+
+static int sumador(void *arg){
+	int i, v;
+
+	for (i=0; i<VUELTAS; i++) {
+		fibra_lock(mutex);
+		v=total;
+		fibra_ceder(); /* que se crucen dentro de la sección crítica */
+		total=v+1;
+		fibra_unlock(mutex);
+	}
+	return (long)arg*10;
+}
+
+static int dormilona(void *arg){
+	fibra_dormir_ms((long)arg);
+	orden[num_orden++]=(long)arg;
+	durmiendo--;
+	return 0;
+}
+
+static int libre(void *arg){
+	while (durmiendo>0) {
+		vueltas_libre++;
+		fibra_ceder();
+	}
+	return 0;
+}
+
+static int pelota_fibra(void *arg){
+	int i;
+
+	for (i=0; i<CAMBIOS_FIBRAS; i++)
+		fibra_ceder();
+	return 0;
+}
+
+static int pelota_hilo(void *arg){
+	int i;
+
+	for (i=0; i<CAMBIOS_HILOS; i++)
+		ceder();
+	return 0;
+}
+
+static unsigned long long us_desde(unsigned long long ini){
+	unsigned long long ahora;
+
+	obtener_tiempo(RELOJ_MONOTONO, &ahora);
+	return ahora-ini;
+}
+
+int main(){
+	int i, a, b, estado, ids[NFIBRAS], pids[EFIMEROS], mal=0;
+	unsigned long long ini, t_fibras, t_hilos;
+
+	printf("prueba_fibras: comienza\n");
+
+	/* el mutex sólo para a la fibra que no lo consigue */
+	mutex=crear_mutex("fibras", NO_RECURSIVO);
+	for (i=0; i<NFIBRAS; i++)
+		ids[i]=fibra_crear(sumador, (void *)(long)i);
+	for (i=0; i<NFIBRAS; i++)
+		if (fibra_esperar(ids[i], &estado)!=ids[i] || estado!=i*10)
+			mal++;
+	printf("prueba_fibras: total %d (debe ser %d)\n", total, NFIBRAS*VUELTAS);
+	if (total!=NFIBRAS*VUELTAS)
+		mal++;
+	if (fibra_esperar(ids[0], &estado)>=0) /* ya recogida */
+		mal++;
+	if (fibra_unlock(mutex)>=0) /* no lo tiene nadie */
+		mal++;
+
+	/* mientras duermen dos, la otra sigue ejecutando */
+	durmiendo=2;
+	a=fibra_crear(dormilona, (void *)60L);
+	b=fibra_crear(dormilona, (void *)20L);
+	i=fibra_crear(libre, 0);
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	fibra_esperar(a, 0);
+	fibra_esperar(b, 0);
+	fibra_esperar(i, 0);
+	printf("prueba_fibras: despiertan %d y %d ms, a los %d ms, con %d vueltas de la otra\n",
+		orden[0], orden[1], (int)(us_desde(ini)/1000), vueltas_libre);
+	if (orden[0]!=20 || orden[1]!=60 || vueltas_libre==0)
+		mal++;
+
+	/* termina en una fibra cuando ya no caben más pilas en la reserva */
+	a=crear_proceso("abandona_fibras");
+	crear_procesos("efimero", EFIMEROS, pids);
+	for (i=0; i<EFIMEROS; i++)
+		esperar_proceso(pids[i], 0);
+	if (esperar_proceso(a, &estado)!=a || estado!=7)
+		mal++;
+	printf("prueba_fibras: abandona_fibras termina con %d\n", estado);
+
+	/* coste de un cambio entre fibras frente a uno entre hilos */
+	a=fibra_crear(pelota_fibra, 0);
+	b=fibra_crear(pelota_fibra, 0);
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	fibra_esperar(a, 0);
+	fibra_esperar(b, 0);
+	t_fibras=us_desde(ini);
+	a=crear_hilo(pelota_hilo, 0);
+	b=crear_hilo(pelota_hilo, 0);
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	esperar_hilo(a, 0);
+	esperar_hilo(b, 0);
+	t_hilos=us_desde(ini);
+	printf("prueba_fibras: cambio entre fibras %d ns, entre hilos %d ns\n",
+		(int)(t_fibras*1000/(2*CAMBIOS_FIBRAS)),
+		(int)(t_hilos*1000/(2*CAMBIOS_HILOS)));
+
+	printf("prueba_fibras: %d errores (debe ser 0)\n", mal);
+	printf("prueba_fibras: termina\n");
+	return 0;
+}
@@ -0,0 +1,29 @@
+/*
+ * usuario/prueba_grupos.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de los grupos de reparto de
+ * CPU. Crea un proceso inquilino, que se mete en un grupo con cuota y
+ * lanza varios procesos mudo, y otro mudo fuera del grupo. Aunque el
+ * inquilino tenga más procesos, el mudo de fuera debe terminar antes.
+ */
+
+#include "servicios.h"
+
+int main(){
+	printf("prueba_grupos: comienza\n");
+
+	if (crear_proceso("inquilino")<0)
+		printf("Error creando inquilino\n");
+	if (crear_proceso("mudo")<0)
+		printf("Error creando mudo\n");
+
+	printf("prueba_grupos: termina\n");
+	return 0;
+}
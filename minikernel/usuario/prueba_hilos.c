@@ -0,0 +1,109 @@
+/*
+ * usuario/prueba_hilos.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que prueba los hilos: comparten las variables
+ * globales y los mutex, esperar_hilo recoge el valor que devuelven, una
+ * excepción sólo mata al hilo y los hilos mueren con su proceso (ver
+ * abandona). Al final compara lo que cuesta crear y esperar un hilo que
+ * no hace nada con lo que cuesta el proceso vacio, con los mismos datos
+ * globales: los hilos no copian los datos ni al crearse ni al cambiar de
+ * uno a otro.
+ */
+
+#include "servicios.h"
+
+#define NHILOS 4
+#define VUELTAS 50
+#define VECES 200
+
+int mutex, total, cero;
+char relleno[64*1024];
+
+static int sumador(void *arg){
+	int i, v;
+
+	for (i=0; i<VUELTAS; i++) {
+		lock(mutex);
+		v=total;
+		ceder(); /* que se crucen dentro de la sección crítica */
+		total=v+1;
+		unlock(mutex);
+	}
+	return (long)arg*10;
+}
+
+static int divisor(void *arg){
+	int i=(long)arg+100;
+
+	i/=cero; /* excepción aritmética */
+	return i;
+}
+
+static int vacio(void *arg){
+	return 0;
+}
+
+static unsigned long long us_desde(unsigned long long ini){
+	unsigned long long ahora;
+
+	obtener_tiempo(RELOJ_MONOTONO, &ahora);
+	return ahora-ini;
+}
+
+int main(){
+	int i, id, estado, ids[NHILOS], mal=0;
+	unsigned long long ini, t_hilos, t_procesos;
+
+	printf("prueba_hilos: comienza\n");
+
+	/* variables y mutex compartidos */
+	mutex=crear_mutex("hilos", NO_RECURSIVO);
+	for (i=0; i<NHILOS; i++)
+		ids[i]=crear_hilo(sumador, (void *)(long)i);
+	for (i=0; i<NHILOS; i++)
+		if (esperar_hilo(ids[i], &estado)!=ids[i] || estado!=i*10)
+			mal++;
+	printf("prueba_hilos: total %d (debe ser %d)\n", total, NHILOS*VUELTAS);
+	if (total!=NHILOS*VUELTAS)
+		mal++;
+	if (esperar_hilo(ids[0], &estado)>=0) /* ya recogido */
+		mal++;
+
+	/* la excepción sólo mata al hilo */
+	id=crear_hilo(divisor, 0);
+	esperar_hilo(id, &estado);
+	printf("prueba_hilos: el hilo con excepcion termina con %d\n", estado);
+	if (estado!=-1)
+		mal++;
+
+	/* los hilos mueren con su proceso */
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	id=crear_proceso("abandona");
+	if (esperar_proceso(id, &estado)!=id || estado!=0)
+		mal++;
+	printf("prueba_hilos: abandona recogido a los %d ms\n",
+		(int)(us_desde(ini)/1000));
+
+	/* coste de un hilo frente a un proceso */
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	for (i=0; i<VECES; i++)
+		esperar_hilo(crear_hilo(vacio, 0), 0);
+	t_hilos=us_desde(ini);
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	for (i=0; i<VECES; i++)
+		esperar_proceso(crear_proceso("vacio"), 0);
+	t_procesos=us_desde(ini);
+	printf("prueba_hilos: hilo %d us, proceso %d us\n",
+		(int)(t_hilos/VECES), (int)(t_procesos/VECES));
+
+	printf("prueba_hilos: %d errores (debe ser 0)\n", mal);
+	printf("prueba_hilos: termina\n");
+	return 0;
+}
@@ -0,0 +1,42 @@
+/*
+ * usuario/prueba_holgura.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de la holgura de los
+ * temporizadores. Lanza dos tandas de despertadores, la primera sin
+ * holgura y la segunda con 40 ms, que heredan. Comparando los contadores
+ * que escribe el núcleo al terminar cada proceso, en la segunda tanda
+ * debe haber menos ticks con despertares y menos cambios de contexto.
+ */
+
+#include "servicios.h"
+
+#define DESPERTADORES 4
+
+static void tanda(unsigned int holgura){
+	int i;
+
+	printf("prueba_holgura: tanda con holgura %u us\n", holgura);
+	fijar_holgura(holgura);
+	for (i=0; i<DESPERTADORES; i++)
+		if (crear_proceso("despertador")<0)
+			printf("Error creando despertador\n");
+	fijar_holgura(0);
+	dormir(3); /* a que terminen */
+}
+
+int main(){
+	printf("prueba_holgura: comienza\n");
+
+	tanda(0);
+	tanda(40000);
+
+	printf("prueba_holgura: termina\n");
+	return 0;
+}
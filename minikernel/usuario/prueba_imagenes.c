@@ -0,0 +1,49 @@
+/*
+ * usuario/prueba_imagenes.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que prueba la caché de imágenes. Primero mide lo
+ * que tarda crear_proceso con un programa que ya ha terminado antes de
+ * crear el siguiente, de modo que sin caché habría que volver a cargarlo
+ * cada vez. Después ejecuta a la vez varios contador, que deben tener
+ * cada uno sus propios datos.
+ */
+
+#include "servicios.h"
+
+#define VECES 50
+#define CONTADORES 3
+
+int main(){
+	int i;
+	unsigned long long ini, fin, primera=0, resto=0;
+
+	printf("prueba_imagenes: comienza\n");
+
+	for (i=0; i<VECES; i++) {
+		obtener_tiempo(RELOJ_MONOTONO, &ini);
+		if (crear_proceso("simplon")<0)
+			printf("Error creando simplon\n");
+		obtener_tiempo(RELOJ_MONOTONO, &fin);
+		if (i==0)
+			primera=fin-ini;
+		else
+			resto+=fin-ini;
+		dormir_ms(20); /* a que termine */
+	}
+	printf("prueba_imagenes: crear simplon la primera vez %llu us, luego %llu us\n",
+		primera, resto/(VECES-1));
+
+	for (i=0; i<CONTADORES; i++)
+		if (crear_proceso("contador")<0)
+			printf("Error creando contador\n");
+
+	printf("prueba_imagenes: termina\n");
+	return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * usuario/prueba_lotes.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que compara crear LOTE procesos con otras tantas
+ * llamadas a crear_proceso y con una sola llamada a crear_procesos.
+ * Después comprueba que se informa de cada proceso que no se crea.
+ */
+
+#include "servicios.h"
+
+#define LOTE 200
+
+int pids[LOTE];
+
+int main(){
+	int i, n;
+	unsigned long long ini, fin;
+
+	printf("prueba_lotes: comienza\n");
+
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	for (i=0; i<LOTE; i++)
+		pids[i]=crear_proceso("efimero");
+	obtener_tiempo(RELOJ_MONOTONO, &fin);
+	printf("prueba_lotes: %d crear_proceso, %llu us\n", LOTE, fin-ini);
+	dormir(1); /* a que terminen */
+
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	n=crear_procesos("efimero", LOTE, pids);
+	obtener_tiempo(RELOJ_MONOTONO, &fin);
+	printf("prueba_lotes: crear_procesos de %d, %llu us (%d creados)\n",
+		LOTE, fin-ini, n);
+	printf("prueba_lotes: primero %d, ultimo %d\n", pids[0], pids[LOTE-1]);
+	dormir(1);
+
+	n=crear_procesos("no_existe", 3, pids);
+	printf("prueba_lotes: no_existe: %d creados, pids %d %d %d (deben ser -1)\n",
+		n, pids[0], pids[1], pids[2]);
+	if (crear_procesos("efimero", 0, pids)>=0)
+		printf("crear_procesos de 0 procesos. NO DEBE APARECER\n");
+
+	printf("prueba_lotes: termina\n");
+	return 0;
+}
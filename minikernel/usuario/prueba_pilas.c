@@ -0,0 +1,32 @@
+/*
+ * usuario/prueba_pilas.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que prueba las pilas de los procesos: uno que
+ * necesita y pide una pila grande, otro que desborda la suya y debe
+ * terminar con una excepción de memoria sin afectar a los demás.
+ */
+
+#include "servicios.h"
+
+int main(){
+	printf("prueba_pilas: comienza\n");
+
+	if (crear_proceso("recursivo")<0)
+		printf("Error creando recursivo\n");
+	if (crear_proceso("desbordador")<0)
+		printf("Error creando desbordador\n");
+	dormir(1);
+	if (crear_proceso("recursivo")<0)
+		printf("Error creando recursivo\n");
+	dormir(1);
+
+	printf("prueba_pilas: termina\n");
+	return 0;
+}
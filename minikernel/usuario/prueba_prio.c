@@ -0,0 +1,32 @@
+/*
+ * usuario/prueba_prio.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de la planificación por
+ * prioridades: arranca varios procesos que gastan CPU y uno interactivo
+ * más prioritario que debe ejecutar nada más despertarse.
+ */
+
+#include "servicios.h"
+
+int main(){
+	int i;
+
+	printf("prueba_prio: comienza\n");
+
+	for (i=1; i<=3; i++)
+		if (crear_proceso("mudo")<0)
+			printf("Error creando mudo\n");
+
+	if (crear_proceso("interactivo")<0)
+		printf("Error creando interactivo\n");
+
+	printf("prueba_prio: termina\n");
+	return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * usuario/prueba_procesos.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de la tabla de procesos
+ * dinámica. Crea varias tandas de procesos efimero, todos vivos a la vez
+ * dentro de cada tanda, de modo que la tabla tiene que crecer, y los
+ * espera antes de la siguiente para que se reutilicen sus entradas. Al
+ * final comprueba que el identificador de un proceso ya terminado no vale
+ * para el que ocupa ahora su entrada.
+ */
+
+#include "servicios.h"
+
+#define TANDAS 4
+#define POR_TANDA 500
+
+int main(){
+	int i, t, pid, primero=-1, creados=0, fallos=0;
+
+	printf("prueba_procesos: comienza\n");
+
+	for (t=0; t<TANDAS; t++) {
+		for (i=0; i<POR_TANDA; i++) {
+			if ((pid=crear_proceso("efimero"))<0)
+				fallos++;
+			else {
+				creados++;
+				if (primero<0)
+					primero=pid;
+			}
+		}
+		printf("prueba_procesos: tanda %d, ultimo id %d\n", t, pid);
+		while (esperar_proceso(ESPERA_CUALQUIERA, 0)>=0)
+			; /* a que terminen todos */
+	}
+	printf("prueba_procesos: %d procesos creados, %d fallos\n",
+		creados, fallos);
+
+	if (ceder_a(primero)>=0)
+		printf("ceder_a a un proceso terminado. NO DEBE APARECER\n");
+
+	printf("prueba_procesos: termina\n");
+	return 0;
+}
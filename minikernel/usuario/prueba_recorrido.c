@@ -0,0 +1,48 @@
+/*
+ * usuario/prueba_recorrido.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que mide lo que cuesta recorrer la tabla de
+ * procesos. Cada cerrar_mutex de un mutex que no usa nadie más mira los
+ * descriptores de todas las entradas, así que se repite crear_mutex y
+ * cerrar_mutex con cada vez más procesos durmiente vivos y se saca el
+ * tiempo medio por pareja.
+ */
+
+#include "servicios.h"
+
+#define REPETICIONES 2000
+
+static int tamanos[]={0, 500, 1000, 2000, 4000};
+
+int main(){
+	int i, t, vivos=0, desc;
+	unsigned long long ini, fin;
+
+	printf("prueba_recorrido: comienza\n");
+
+	for (t=0; t<sizeof(tamanos)/sizeof(tamanos[0]); t++) {
+		for (; vivos<tamanos[t]; vivos++)
+			if (crear_proceso("durmiente")<0) {
+				printf("prueba_recorrido: no se pueden crear mas procesos\n");
+				return -1;
+			}
+		obtener_tiempo(RELOJ_MONOTONO, &ini);
+		for (i=0; i<REPETICIONES; i++) {
+			desc=crear_mutex("tabla", NO_RECURSIVO);
+			cerrar_mutex(desc);
+		}
+		obtener_tiempo(RELOJ_MONOTONO, &fin);
+		printf("prueba_recorrido: %d procesos, %llu us por recorrido\n",
+			vivos, (fin-ini)/REPETICIONES);
+	}
+
+	printf("prueba_recorrido: termina\n");
+	return 0;
+}
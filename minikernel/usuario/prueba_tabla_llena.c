@@ -0,0 +1,61 @@
+/*
+ * usuario/prueba_tabla_llena.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que prueba crear_proceso_espera con la tabla de
+ * procesos llena: sin esperar falla en el acto, con plazo falla al
+ * acabarse éste y sin límite crea el proceso cuando terminan los
+ * procesos durmiente que la llenan.
+ */
+
+#include "servicios.h"
+
+static unsigned long long ms_desde(unsigned long long ini){
+	unsigned long long ahora;
+
+	obtener_tiempo(RELOJ_MONOTONO, &ahora);
+	return (ahora-ini)/1000;
+}
+
+int main(){
+	int pid, n, mal=0;
+	unsigned long long ini;
+
+	printf("prueba_tabla_llena: comienza\n");
+
+	pid=crear_proceso("llenador");
+	esperar_proceso(pid, &n);
+	/* al recogerlo queda libre su entrada */
+	crear_proceso("durmiente");
+
+	if (crear_proceso("efimero")>=0)
+		mal++;
+	if (crear_proceso_espera("efimero", 0)>=0)
+		mal++;
+
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	pid=crear_proceso_espera("efimero", 300);
+	printf("prueba_tabla_llena: con plazo de 300 ms devuelve %d a los %d ms\n",
+		pid, (int)ms_desde(ini));
+	if (pid>=0 || ms_desde(ini)<300)
+		mal++;
+
+	obtener_tiempo(RELOJ_MONOTONO, &ini);
+	pid=crear_proceso_espera("efimero", ESPERA_INDEFINIDA);
+	printf("prueba_tabla_llena: sin limite crea %d a los %d ms\n",
+		pid, (int)ms_desde(ini));
+	if (pid<0)
+		mal++;
+
+	while (esperar_proceso(ESPERA_CUALQUIERA, 0)>=0)
+		;
+	printf("prueba_tabla_llena: %d errores (debe ser 0)\n", mal);
+	printf("prueba_tabla_llena: termina\n");
+	return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * usuario/prueba_temporizador.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de dormir_hasta y del
+ * temporizador periódico. Ejecuta el mismo bucle periódico de tres
+ * maneras: con esperas relativas (dormir_ms), que acumulan el tiempo de
+ * trabajo de cada vuelta, con esperas absolutas (dormir_hasta) y con el
+ * temporizador, que no deben desviarse más de un tick del instante
+ * ideal. En alguna vuelta el trabajo dura más que el periodo para ver
+ * que el temporizador cuenta los periodos perdidos.
+ */
+
+#include "servicios.h"
+
+#define PERIODO 50000	/* 50 ms */
+#define VUELTAS 10
+
+static unsigned long long ahora(){
+	unsigned long long t;
+
+	obtener_tiempo(RELOJ_MONOTONO, &t);
+	return t;
+}
+
+/* ocupa el procesador durante us microsegundos */
+static void trabajar(unsigned long long us){
+	unsigned long long fin=ahora()+us;
+
+	while (ahora()<fin);
+}
+
+int main(){
+	unsigned long long ini, ideal;
+	int i, n, perdidos=0;
+
+	printf("prueba_temporizador: comienza\n");
+
+	if (esperar_temporizador()>=0)
+		printf("espera sin temporizador. NO DEBE APARECER\n");
+
+	/* espera relativa: se retrasa el trabajo de cada vuelta */
+	ini=ahora();
+	for (i=0; i<VUELTAS; i++) {
+		trabajar(15000);
+		dormir_ms(PERIODO/1000);
+	}
+	printf("prueba_temporizador: dormir_ms: retraso acumulado %lld us\n",
+		(long long)(ahora()-ini-VUELTAS*PERIODO));
+
+	/* espera absoluta */
+	ini=ideal=ahora();
+	for (i=0; i<VUELTAS; i++) {
+		trabajar(15000);
+		ideal+=PERIODO;
+		dormir_hasta(ideal);
+	}
+	printf("prueba_temporizador: dormir_hasta: retraso acumulado %lld us\n",
+		(long long)(ahora()-ini-VUELTAS*PERIODO));
+
+	/* temporizador, perdiendo periodos en la vuelta 4 */
+	ini=ideal=ahora();
+	fijar_temporizador(PERIODO);
+	for (i=0; i<VUELTAS; i++) {
+		trabajar(i==4 ? 5*PERIODO/2 : 15000);
+		n=esperar_temporizador();
+		ideal+=n*PERIODO;
+		if (n>1)
+			perdidos+=n-1;
+		printf("prueba_temporizador: vencimiento %d, desvio %lld us\n",
+			n, (long long)(ahora()-ideal));
+	}
+	fijar_temporizador(0);
+	printf("prueba_temporizador: temporizador: %d periodos perdidos (debe ser 1), retraso acumulado %lld us\n",
+		perdidos, (long long)(ahora()-ini-(VUELTAS+perdidos)*PERIODO));
+
+	printf("prueba_temporizador: termina\n");
+	return 0;
+}
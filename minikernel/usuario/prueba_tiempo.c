@@ -0,0 +1,62 @@
+/*
+ * usuario/prueba_tiempo.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que realiza una prueba de dormir_ms, dormir_us y
+ * obtener_tiempo. Duerme distintos intervalos, mide con el reloj
+ * monótono lo que ha durado cada espera, que nunca debe ser menos de lo
+ * pedido ni pasarse un tick (10 ms) o más, y al final compara el tiempo
+ * total según el reloj monótono y el CMOS para ver la deriva.
+ */
+
+#include "servicios.h"
+
+static unsigned long long ahora(int reloj){
+	unsigned long long t;
+
+	if (obtener_tiempo(reloj, &t)<0)
+		printf("error en obtener_tiempo. NO DEBE APARECER\n");
+	return t;
+}
+
+int main(){
+	unsigned int esperas[]={1, 500, 4000, 10000, 15000, 123456, 250000};
+	unsigned long long ini, fin, cmos_ini, cmos_fin, medido;
+	unsigned long long t;
+	int i;
+
+	printf("prueba_tiempo: comienza\n");
+
+	if (obtener_tiempo(-1, &t)>=0)
+		printf("obtener_tiempo con reloj erróneo. NO DEBE APARECER\n");
+
+	cmos_ini=ahora(RELOJ_CMOS);
+	ini=ahora(RELOJ_MONOTONO);
+	for (i=0; i<sizeof(esperas)/sizeof(esperas[0]); i++) {
+		t=ahora(RELOJ_MONOTONO);
+		if (esperas[i]%1000)
+			dormir_us(esperas[i]);
+		else
+			dormir_ms(esperas[i]/1000);
+		medido=ahora(RELOJ_MONOTONO)-t;
+		printf("prueba_tiempo: pide %u us, duerme %llu us (+%lld)%s\n",
+			esperas[i], medido, (long long)(medido-esperas[i]),
+			(medido<esperas[i] || medido-esperas[i]>=10000) ?
+			" FUERA DE MARGEN. NO DEBE APARECER" : "");
+	}
+	fin=ahora(RELOJ_MONOTONO);
+	cmos_fin=ahora(RELOJ_CMOS);
+
+	printf("prueba_tiempo: total %llu us monotono, %llu us CMOS, deriva %lld us\n",
+		fin-ini, cmos_fin-cmos_ini,
+		(long long)(fin-ini)-(long long)(cmos_fin-cmos_ini));
+
+	printf("prueba_tiempo: termina\n");
+	return 0;
+}
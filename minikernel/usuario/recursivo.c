@@ -0,0 +1,33 @@
+/*
+ * usuario/recursivo.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que usa unos 100 KB de pila con una función
+ * recursiva, así que tiene que pedir una pila mayor que la normal
+ */
+
+#include "servicios.h"
+
+#define NIVELES 100
+
+TAMANO_PILA(128*1024);
+
+static int bajar(int nivel){
+	volatile char hueco[1024];
+
+	hueco[0]=nivel;
+	if (nivel==0)
+		return 0;
+	return bajar(nivel-1)+hueco[0];
+}
+
+int main(){
+	printf("recursivo: suma %d\n", bajar(NIVELES));
+	return 0;
+}
@@ -0,0 +1,26 @@
+/*
+ * usuario/saliente.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que espera un poco, más cuanto mayor es su
+ * identificador, y termina con un estado que depende de él, para que lo
+ * compruebe su padre
+ */
+
+#include "servicios.h"
+
+int main(){
+	int id;
+
+	id=obtener_id_pr();
+	dormir_ms((id%4)*20);
+	salir(id%100);
+	printf("saliente (%d): sigue despues de salir. NO DEBE APARECER\n", id);
+	return 0;
+}
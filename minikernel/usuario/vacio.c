@@ -0,0 +1,23 @@
+/*
+ * usuario/vacio.c
+ *
+ *  Minikernel. Versión 1.0
+ *
+ *  Fernando Pérez Costoya
+ *
+ */
+
+/*
+ * Programa de usuario que termina nada más empezar, para medir lo que
+ * cuesta crear un proceso y esperarlo. Tiene tantos datos globales como
+ * prueba_hilos, que se copian al crearlo y en cada cambio de contexto.
+ */
+
+#include "servicios.h"
+
+char relleno[64*1024];
+
+int main(){
+	salir(0);
+	return 0;
+}